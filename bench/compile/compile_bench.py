@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""Measures how long the headers in include/ take to compile.
+
+Each case is a generated translation unit, compiled to an object file that is
+thrown away. Wall time and peak RSS of the compiler are reported as a markdown
+table, with the number of template instantiations. These are counted in one
+more compilation, which is not timed: with clang, from -ftime-trace output,
+and with gcc, from the classes of -fdump-lang-class and the functions of
+-fdump-tree-original that are specializations of templates.
+
+Cases:
+  universe    Universe of N elements, the Set and KPerm of all of them, and a
+              greedy MinSetCover of that set by N/2 overlapping candidates.
+  evaluator   Evaluator over a universe of N elements and F functors with
+              overlapping outputs, and four Evaluator::eval instantiations
+              that each query Q elements.
+"""
+
+import argparse
+import glob
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+REPO = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+def universe_case(elements):
+    n = elements
+    names = ", ".join(f"E<{i}>" for i in range(n))
+    candidates = ", ".join(
+        f"U::Set<E<{i}>, E<{(i + 1) % n}>, E<{(i + 2) % n}>>" for i in range(0, n, 2)
+    )
+    return f"""#include <MinSetCover.h>
+#include <TypeSet.h>
+using namespace set_cover;
+template <int> struct E {{}};
+using U = Universe<{names}>;
+using All = U::Set<{names}>;
+using Perm = U::KPerm<{names}>;
+using Cover =
+    decltype(MinSetCover<Greedy<TightestOneWins>>::eval<All, {candidates}>());
+static_assert(std::tuple_size_v<Cover> != 0);
+static_assert(Perm::size() == {n});
+"""
+
+
+def evaluator_case(elements, functors, width):
+    n = elements
+    names = ", ".join(f"P<{i}>" for i in range(n))
+    # Functor j covers a window of consecutive elements. Windows overlap, and
+    # together they cover the whole universe.
+    span = -(-n // functors) + 1
+    lines = [
+        "#include <Evaluator.h>",
+        "using namespace set_cover;",
+        "template <int> struct P { using Type = int; };",
+        f"using U = Universe<{names}>;",
+    ]
+    for j in range(functors):
+        window = [(j * n // functors + k) % n for k in range(span)]
+        outputs = ", ".join(f"P<{i}>" for i in window)
+        types = ", ".join("int" for _ in window)
+        values = ", ".join(f"aIn + {i}" for i in window)
+        lines += [
+            f"struct F{j} {{",
+            f"  using EvalList = U::KPerm<{outputs}>;",
+            f"  std::tuple<{types}> operator()(int aIn) {{ return {{{values}}}; }}",
+            "};",
+        ]
+    all_functors = ", ".join(f"F{j}" for j in range(functors))
+    lines.append(f"using MyEvaluator = Evaluator<U, LogNothing, {all_functors}>;")
+    lines.append("int run(int aIn) {")
+    lines.append("  MyEvaluator e;")
+    lines.append("  int sum = 0;")
+    for q in range(4):
+        query = sorted({(q + k * n // width) % n for k in range(width)})
+        evaluables = ", ".join(f"P<{i}>" for i in query)
+        lines.append(
+            f"  sum += std::get<0>(e.eval<{evaluables}>(aIn + {q}));")
+    lines.append("  return sum;")
+    lines.append("}")
+    return "\n".join(lines) + "\n"
+
+
+def is_clang(compiler):
+    version = subprocess.run([compiler, "--version"], capture_output=True,
+                             text=True, check=True).stdout
+    return "clang" in version
+
+
+def count_clang_instantiations(dump_dir):
+    count = 0
+    for path in glob.glob(os.path.join(dump_dir, "*.json")):
+        with open(path) as f:
+            events = json.load(f)["traceEvents"]
+        count += sum(1 for event in events
+                     if event.get("name") in ("InstantiateClass",
+                                              "InstantiateFunction"))
+    return count
+
+
+def count_gcc_instantiations(dump_dir):
+    # Classes are dumped once they are complete, functions once their body is
+    # parsed or instantiated. gcc names specializations of class templates
+    # with their arguments, and specializations of function templates, or of
+    # members of class templates, with a "[with ...]" suffix.
+    instantiations = set()
+    for path in glob.glob(os.path.join(dump_dir, "*.class")):
+        with open(path) as f:
+            instantiations.update(line for line in f
+                                  if line.startswith("Class ") and "<" in line)
+    for path in glob.glob(os.path.join(dump_dir, "*.original")):
+        with open(path) as f:
+            instantiations.update(line for line in f
+                                  if line.startswith(";; Function ")
+                                  and " [with " in line)
+    return len(instantiations)
+
+
+def compile_case(compiler, include, source, count):
+    """Returns (wall seconds, peak RSS in MiB, instantiations or None).
+
+    count is None, or the count_*_instantiations function of the compiler, in
+    which case the compiler also writes the output that it reads.
+    """
+    work_dir = tempfile.mkdtemp()
+    try:
+        path = os.path.join(work_dir, "case.cpp")
+        with open(path, "w") as f:
+            f.write(source)
+        command = [compiler, "-std=c++17", "-O1", "-I", include, "-c", path,
+                   "-o", os.path.join(work_dir, "case.o")]
+        if count is count_clang_instantiations:
+            command += ["-ftime-trace", "-ftime-trace-granularity=0"]
+        elif count is count_gcc_instantiations:
+            command += ["-fdump-lang-class", "-fdump-tree-original"]
+        start = time.perf_counter()
+        process = subprocess.Popen(command)
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.perf_counter() - start
+        if status != 0:
+            sys.exit(f"compilation failed: {' '.join(command)}")
+        instantiations = count(work_dir) if count else None
+        return wall, usage.ru_maxrss / 1024, instantiations
+    finally:
+        shutil.rmtree(work_dir)
+
+
+def cases(args):
+    sizes = [int(size) for size in args.sizes.split(",")]
+    for n in sizes:
+        yield "universe", (n, "-", "-"), universe_case(n)
+    for n in sizes:
+        for functors in (int(f) for f in args.functors.split(",")):
+            for width in (int(w) for w in args.widths.split(",")):
+                if width <= n:
+                    yield ("evaluator", (n, functors, width),
+                           evaluator_case(n, functors, width))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--compiler", default=os.environ.get("CXX", "c++"))
+    parser.add_argument("--include", default=os.path.join(REPO, "include"))
+    parser.add_argument("--sizes", default="16,32,64",
+                        help="numbers of elements in the universe")
+    parser.add_argument("--functors", default="8,16",
+                        help="numbers of functors of evaluator cases")
+    parser.add_argument("--widths", default="2,8",
+                        help="numbers of evaluables per query of evaluator cases")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="runs per case; the fastest is reported")
+    parser.add_argument("--output", help="also write the table to this file")
+    args = parser.parse_args()
+
+    count = (count_clang_instantiations if is_clang(args.compiler)
+             else count_gcc_instantiations)
+    version = subprocess.run([args.compiler, "--version"], capture_output=True,
+                             text=True, check=True).stdout.splitlines()[0]
+    lines = [
+        f"Compiler: {version}, best of {args.repeat} runs.",
+        "",
+        "| case | elements | functors | query width | wall (s) "
+        "| peak RSS (MiB) | instantiations |",
+        "|---|---:|---:|---:|---:|---:|---:|",
+    ]
+    for line in lines:
+        print(line)
+    for name, (n, functors, width), source in cases(args):
+        runs = [compile_case(args.compiler, args.include, source, None)
+                for _ in range(args.repeat)]
+        wall = min(run[0] for run in runs)
+        rss = min(run[1] for run in runs)
+        _, _, instantiations = compile_case(args.compiler, args.include,
+                                            source, count)
+        line = (f"| {name} | {n} | {functors} | {width} | {wall:.2f} "
+                f"| {rss:.0f} | {instantiations} |")
+        lines.append(line)
+        print(line, flush=True)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,130 @@
+#include <IntList.h>
+
+#include <benchmark/benchmark.h>
+#include <numeric>
+#include <random>
+
+using namespace set_cover;
+using namespace set_cover::int_list;
+
+namespace {
+
+std::vector<int> makeInput(std::size_t aSize) {
+  std::mt19937 generator(aSize);
+  std::uniform_int_distribution<int> distribution(-1000000, 1000000);
+  std::vector<int> input(aSize);
+  for (int &value : input) {
+    value = distribution(generator);
+  }
+  return input;
+}
+
+// The getters of the IntList of the README, one call per property.
+template <typename tProperty>
+typename tProperty::Type perProperty(const std::vector<int> &aIn) {
+  if constexpr (std::is_same_v<tProperty, Min>) {
+    return *std::min_element(aIn.begin(), aIn.end());
+  } else if constexpr (std::is_same_v<tProperty, Max>) {
+    return *std::max_element(aIn.begin(), aIn.end());
+  } else if constexpr (std::is_same_v<tProperty, Avg>) {
+    return std::accumulate(aIn.begin(), aIn.end(), 0.0) / aIn.size();
+  } else if constexpr (std::is_same_v<tProperty, Var>) {
+    const double avg = perProperty<Avg>(aIn);
+    double var = 0;
+    for (int val : aIn) {
+      var += (val - avg) * (val - avg);
+    }
+    return var / aIn.size();
+  } else {
+    std::vector<int> sorted = aIn;
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() / 2];
+  }
+}
+
+// One call per property as well, with the kernels and the partition that the
+// functors of IntList use, so that against Dispatched only the cover differs.
+template <typename tProperty>
+typename tProperty::Type perKernel(const std::vector<int> &aIn,
+                                   std::vector<int> &aScratch) {
+  if constexpr (std::is_same_v<tProperty, Min>) {
+    return minMax(aIn.data(), aIn.size()).first;
+  } else if constexpr (std::is_same_v<tProperty, Max>) {
+    return minMax(aIn.data(), aIn.size()).second;
+  } else if constexpr (std::is_same_v<tProperty, Avg>) {
+    return averageAndVariance(moments(aIn.data(), aIn.size()), aIn.size())
+        .first;
+  } else if constexpr (std::is_same_v<tProperty, Var>) {
+    return averageAndVariance(moments(aIn.data(), aIn.size()), aIn.size())
+        .second;
+  } else {
+    aScratch.assign(aIn.begin(), aIn.end());
+    const auto middle = aScratch.begin() + aScratch.size() / 2;
+    std::nth_element(aScratch.begin(), middle, aScratch.end());
+    return *middle;
+  }
+}
+
+template <typename... tProperties>
+void perPropertyCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(
+        std::make_tuple(perProperty<tProperties>(input)...));
+  }
+}
+
+template <typename... tProperties>
+void perKernelCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  std::vector<int> scratch;
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(
+        std::make_tuple(perKernel<tProperties>(input, scratch)...));
+  }
+}
+
+template <typename... tProperties>
+void evaluatorCase(benchmark::State &aState, Isa aIsa) {
+  const auto input = makeInput(aState.range(0));
+  IntListEvaluator<> e{GetMinMax(aIsa), GetAvgVar(aIsa), GetMedian{},
+                       GetSorted{}};
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(e.eval<tProperties...>(input));
+  }
+}
+
+template <typename... tProperties> void scalarCase(benchmark::State &aState) {
+  evaluatorCase<tProperties...>(aState, Isa::Scalar);
+}
+
+template <typename... tProperties> void bestCase(benchmark::State &aState) {
+  evaluatorCase<tProperties...>(aState, bestIsa());
+}
+
+#define INT_LIST_CASES(aName, ...)                                             \
+  BENCHMARK(perPropertyCase<__VA_ARGS__>)                                      \
+      ->Name("PerProperty/" aName)                                             \
+      ->RangeMultiplier(16)                                                    \
+      ->Range(1 << 8, 1 << 20);                                                \
+  BENCHMARK(perKernelCase<__VA_ARGS__>)                                        \
+      ->Name("PerKernel/" aName)                                               \
+      ->RangeMultiplier(16)                                                    \
+      ->Range(1 << 8, 1 << 20);                                                \
+  BENCHMARK(scalarCase<__VA_ARGS__>)                                           \
+      ->Name("Scalar/" aName)                                                  \
+      ->RangeMultiplier(16)                                                    \
+      ->Range(1 << 8, 1 << 20);                                                \
+  BENCHMARK(bestCase<__VA_ARGS__>)                                             \
+      ->Name("Dispatched/" aName)                                              \
+      ->RangeMultiplier(16)                                                    \
+      ->Range(1 << 8, 1 << 20)
+
+INT_LIST_CASES("Min+Max", Min, Max);
+INT_LIST_CASES("Avg+Var", Avg, Var);
+INT_LIST_CASES("Min+Max+Median", Min, Max, Median);
+INT_LIST_CASES("All", Min, Max, Avg, Var, Median);
+
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,33 @@
+#include "../runtime/Statistics.h"
+#include <MinSetCover.h>
+#include <fstream>
+#include <iostream>
+
+using namespace set_cover;
+using namespace statistics;
+
+using ExactStatisticsEvaluator =
+    Evaluator<U, WithMinSetCover<MinSetCover<Exact>, LogNothing>, GetMin,
+              GetMax, GetSorted, GetAvg, GetVar>;
+
+// Writes the plans of every query over the statistics, with the default set
+// cover and with the exact one, to the file named by the first argument, or
+// else to stdout.
+int main(int aArgc, char **aArgv) {
+  std::ofstream file;
+  if (aArgc > 1) {
+    file.open(aArgv[1]);
+    if (!file) {
+      std::cerr << "Cannot write " << aArgv[1] << "\n";
+      return 1;
+    }
+  }
+  std::ostream &out = aArgc > 1 ? file : std::cout;
+  out << "# Plans\n\n"
+         "Generated by `bench_plans`, see [README.md](README.md).\n\n"
+         "## Default set cover\n\n";
+  StatisticsEvaluator::writePlans(out);
+  out << "\n## Exact set cover\n\n";
+  ExactStatisticsEvaluator::writePlans(out);
+  return 0;
+}
@@ -0,0 +1,258 @@
+#include "Statistics.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <random>
+#include <string>
+
+using namespace set_cover;
+using namespace statistics;
+
+namespace {
+
+using Evaluables = std::tuple<Min, Max, Avg, Var, Sorted>;
+constexpr std::size_t kEvaluableCount = std::tuple_size_v<Evaluables>;
+
+const char *const kNames[kEvaluableCount] = {"Min", "Max", "Avg", "Var",
+                                             "Sorted"};
+
+// The evaluables whose bits are set in tMask, in canonical order.
+template <std::size_t tMask, std::size_t... tIs>
+auto queryOf(std::index_sequence<tIs...>)
+    -> decltype(std::tuple_cat(
+        std::conditional_t<((tMask >> tIs) & 1),
+                           std::tuple<std::tuple_element_t<tIs, Evaluables>>,
+                           std::tuple<>>{}...));
+
+template <std::size_t tMask>
+using Query =
+    decltype(queryOf<tMask>(std::make_index_sequence<kEvaluableCount>{}));
+
+std::string nameOf(std::size_t aMask) {
+  std::string name;
+  for (std::size_t i = 0; i < kEvaluableCount; ++i) {
+    if ((aMask >> i) & 1) {
+      name += name.empty() ? "" : "+";
+      name += kNames[i];
+    }
+  }
+  return name;
+}
+
+std::vector<int> makeInput(std::size_t aSize) {
+  std::mt19937 generator(aSize);
+  std::uniform_int_distribution<int> distribution(-1000000, 1000000);
+  std::vector<int> input(aSize);
+  for (int &value : input) {
+    value = distribution(generator);
+  }
+  return input;
+}
+
+template <typename tEvaluator, typename... tEvaluables>
+auto evalQuery(tEvaluator &aEvaluator, const std::vector<int> &aIn,
+               std::tuple<tEvaluables...> *) {
+  return aEvaluator.template eval<tEvaluables...>(aIn);
+}
+
+// Each evaluable by the functor that is named after it, without sharing
+// anything between them.
+template <typename tEvaluable>
+typename tEvaluable::Type byHand(const std::vector<int> &aIn) {
+  if constexpr (std::is_same_v<tEvaluable, Min>) {
+    return std::get<0>(GetMin()(aIn));
+  } else if constexpr (std::is_same_v<tEvaluable, Max>) {
+    return std::get<0>(GetMax()(aIn));
+  } else if constexpr (std::is_same_v<tEvaluable, Avg>) {
+    return std::get<0>(GetAvg()(aIn));
+  } else if constexpr (std::is_same_v<tEvaluable, Var>) {
+    return std::get<0>(GetVar()(aIn));
+  } else {
+    return std::get<0>(GetSorted()(aIn));
+  }
+}
+
+template <typename... tEvaluables>
+auto byHand(const std::vector<int> &aIn, std::tuple<tEvaluables...> *) {
+  return std::make_tuple(byHand<tEvaluables>(aIn)...);
+}
+
+// What one would write for the query without a library: a single pass for
+// everything but the variance, which needs the average first, and the extrema
+// from the sorted copy when there is one.
+template <typename... tEvaluables>
+auto fused(const std::vector<int> &aIn, std::tuple<tEvaluables...> *) {
+  constexpr bool needsSorted = (std::is_same_v<tEvaluables, Sorted> || ...);
+  constexpr bool needsVar = (std::is_same_v<tEvaluables, Var> || ...);
+  constexpr bool needsAvg =
+      needsVar || (std::is_same_v<tEvaluables, Avg> || ...);
+  constexpr bool needsExtrema = !needsSorted && ((std::is_same_v<tEvaluables,
+                                                                 Min> ||
+                                                  std::is_same_v<tEvaluables,
+                                                                 Max>) ||
+                                                 ...);
+  std::tuple<typename tEvaluables::Type...> result;
+  std::vector<int> sorted;
+  if constexpr (needsSorted) {
+    sorted = aIn;
+    std::sort(sorted.begin(), sorted.end());
+  }
+  int min = std::numeric_limits<int>::max();
+  int max = std::numeric_limits<int>::min();
+  double sum = 0;
+  if constexpr (needsExtrema || needsAvg) {
+    for (int val : aIn) {
+      if constexpr (needsExtrema) {
+        min = val < min ? val : min;
+        max = val > max ? val : max;
+      }
+      if constexpr (needsAvg) {
+        sum += val;
+      }
+    }
+  }
+  if constexpr (needsSorted) {
+    min = sorted.front();
+    max = sorted.back();
+  }
+  const float avg = sum / aIn.size();
+  float var = 0;
+  if constexpr (needsVar) {
+    for (int val : aIn) {
+      var += (val - avg) * (val - avg);
+    }
+    var /= aIn.size();
+  }
+  auto assign = [&](auto &aTarget, auto *aEvaluable) {
+    using Evaluable = std::remove_pointer_t<decltype(aEvaluable)>;
+    if constexpr (std::is_same_v<Evaluable, Min>) {
+      aTarget = min;
+    } else if constexpr (std::is_same_v<Evaluable, Max>) {
+      aTarget = max;
+    } else if constexpr (std::is_same_v<Evaluable, Avg>) {
+      aTarget = avg;
+    } else if constexpr (std::is_same_v<Evaluable, Var>) {
+      aTarget = var;
+    } else {
+      aTarget = std::move(sorted);
+    }
+  };
+  std::apply(
+      [&](auto &...aTargets) {
+        (assign(aTargets, static_cast<tEvaluables *>(nullptr)), ...);
+      },
+      result);
+  return result;
+}
+
+template <std::size_t tMask> void evaluatorCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  auto *query = static_cast<Query<tMask> *>(nullptr);
+  StatisticsEvaluator e;
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(evalQuery(e, input, query));
+  }
+  // Out of the timed loop, so that logging costs nothing above.
+  Evaluator<U, LogTypeIndex, GetMin, GetMax, GetSorted, GetAvg, GetVar> logged;
+  evalQuery(logged, input, query);
+  aState.counters["functors"] = logged.getLog().size();
+}
+
+template <std::size_t tMask> void parallelCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  auto *query = static_cast<Query<tMask> *>(nullptr);
+  Evaluator<U, WithExecution<ThreadPool>, GetMin, GetMax, GetSorted, GetAvg,
+            GetVar>
+      e;
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(evalQuery(e, input, query));
+  }
+  aState.counters["workers"] = e.getExecution().workerCount();
+}
+
+template <std::size_t tMask> void byHandCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  auto *query = static_cast<Query<tMask> *>(nullptr);
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(byHand(input, query));
+  }
+  aState.counters["functors"] = std::tuple_size_v<Query<tMask>>;
+}
+
+template <std::size_t tMask> void fusedCase(benchmark::State &aState) {
+  const auto input = makeInput(aState.range(0));
+  auto *query = static_cast<Query<tMask> *>(nullptr);
+  for (auto _ : aState) {
+    benchmark::DoNotOptimize(fused(input, query));
+  }
+}
+
+// What Evaluator::eval<Sorted> spends on top of GetSorted: the result of
+// GetSorted is moved into the result buffer by scatter, and out of it again.
+// The vector is moved back for the next iteration.
+void copyCase(benchmark::State &aState) {
+  auto src = GetSorted()(makeInput(aState.range(0)));
+  for (auto _ : aState) {
+    std::tuple<std::optional<std::vector<int>>> tgt;
+    scatter(tgt, std::move(src), std::make_index_sequence<3>{},
+            GetSorted::EvalList{}, U::KPerm<Sorted>{});
+    auto result = std::make_tuple(std::move(*std::get<0>(tgt)));
+    benchmark::DoNotOptimize(result);
+    std::get<0>(src) = std::move(std::get<0>(result));
+  }
+}
+
+template <std::size_t... tMasks>
+void registerCases(std::size_t aMaxSize, std::index_sequence<tMasks...>) {
+  const auto withSizes = [aMaxSize](benchmark::internal::Benchmark *aCase) {
+    for (std::size_t size = 10; size <= aMaxSize; size *= 10) {
+      aCase->Arg(size);
+    }
+    aCase->Unit(benchmark::kMicrosecond);
+  };
+  // Mask 0 is the empty query, which has nothing to measure.
+  ((tMasks == 0 ? void()
+                : (withSizes(benchmark::RegisterBenchmark(
+                       ("Evaluator/" + nameOf(tMasks)).c_str(),
+                       evaluatorCase<tMasks>)),
+                   withSizes(benchmark::RegisterBenchmark(
+                       ("Parallel/" + nameOf(tMasks)).c_str(),
+                       parallelCase<tMasks>)),
+                   withSizes(benchmark::RegisterBenchmark(
+                       ("ByHand/" + nameOf(tMasks)).c_str(),
+                       byHandCase<tMasks>)),
+                   withSizes(benchmark::RegisterBenchmark(
+                       ("Fused/" + nameOf(tMasks)).c_str(),
+                       fusedCase<tMasks>)),
+                   void())),
+   ...);
+  withSizes(benchmark::RegisterBenchmark("Copy/Sorted", copyCase));
+}
+
+} // namespace
+
+// Takes --max_size=N (default 10^8) besides the flags of Google Benchmark.
+int main(int argc, char **argv) {
+  std::size_t maxSize = 100000000;
+  int kept = 1;
+  for (int i = 1; i < argc; ++i) {
+    const char *prefix = "--max_size=";
+    if (std::strncmp(argv[i], prefix, std::strlen(prefix)) == 0) {
+      maxSize = std::strtoull(argv[i] + std::strlen(prefix), nullptr, 10);
+    } else {
+      argv[kept++] = argv[i];
+    }
+  }
+  argc = kept;
+  registerCases(maxSize, std::make_index_sequence<1 << kEvaluableCount>{});
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
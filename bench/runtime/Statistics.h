@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Evaluator.h>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+// The statistics of test/EvaluatorTest.cpp.
+namespace statistics {
+
+struct Min {
+  static constexpr char name[] = "min";
+  using Type = int;
+};
+struct Max {
+  static constexpr char name[] = "max";
+  using Type = int;
+};
+struct Avg {
+  static constexpr char name[] = "avg";
+  using Type = float;
+};
+struct Var {
+  static constexpr char name[] = "var";
+  using Type = float;
+};
+struct Sorted {
+  static constexpr char name[] = "sorted";
+  using Type = std::vector<int>;
+};
+
+using U = set_cover::Universe<Min, Max, Avg, Var, Sorted>;
+
+struct GetMin {
+  static constexpr char name[] = "GetMin";
+  using EvalList = U::KPerm<Min>;
+  std::tuple<int> operator()(const std::vector<int> &aIn) {
+    return *std::min_element(aIn.begin(), aIn.end());
+  }
+};
+
+struct GetMax {
+  static constexpr char name[] = "GetMax";
+  using EvalList = U::KPerm<Max>;
+  std::tuple<int> operator()(const std::vector<int> &aIn) {
+    return *std::max_element(aIn.begin(), aIn.end());
+  }
+};
+
+struct GetSorted {
+  static constexpr char name[] = "GetSorted";
+  using EvalList = U::KPerm<Sorted, Min, Max>;
+  std::tuple<std::vector<int>, int, int>
+  operator()(const std::vector<int> &aIn) {
+    std::vector<int> out = aIn;
+    std::sort(out.begin(), out.end());
+    return {out, out.front(), out.back()};
+  }
+};
+
+struct GetAvg {
+  static constexpr char name[] = "GetAvg";
+  using EvalList = U::KPerm<Avg>;
+  std::tuple<float> operator()(const std::vector<int> &aIn) {
+    return std::accumulate(aIn.begin(), aIn.end(), 0.0) / aIn.size();
+  }
+};
+
+struct GetVar {
+  static constexpr char name[] = "GetVar";
+  using EvalList = U::KPerm<Var, Avg>;
+  std::tuple<float, float> operator()(const std::vector<int> &aIn) {
+    const auto [avg] = GetAvg()(aIn);
+    float var = 0;
+    for (int val : aIn) {
+      var += (val - avg) * (val - avg);
+    }
+    return {var / aIn.size(), avg};
+  }
+};
+
+using StatisticsEvaluator =
+    set_cover::Evaluator<U, set_cover::LogNothing, GetMin, GetMax, GetSorted,
+                         GetAvg, GetVar>;
+
+} // namespace statistics
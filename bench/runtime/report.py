@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Summarizes the JSON output of bench_runtime as markdown.
+
+Cases of bench_runtime, for every non-empty query over Min, Max, Avg, Var and
+Sorted, and for input sizes from 10 up to --max_size:
+  Evaluator   Evaluator::eval of the query.
+  Parallel    The same, with the functors of the cover run on a ThreadPool.
+  ByHand      The functor named after each evaluable, called once per
+              evaluable, so that nothing is shared.
+  Fused       One pass over the input for the whole query, written by hand.
+  Copy        Moves of the result of GetSorted through the result buffer, as
+              done by Evaluator::eval<Sorted>.
+
+Timings are the medians of the repetitions (--benchmark_repetitions), or the
+single run without them. Reported:
+  break-even  The smallest size from which Evaluator is never slower than
+              ByHand by more than TOLERANCE or the spread of the two.
+  dispatch    Evaluator minus ByHand at the smallest size, for queries that
+              both answer by calling the same single functor.
+  copy        The Copy case, per size and per element.
+"""
+
+import argparse
+import json
+from collections import defaultdict
+
+TO_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+# Relative difference below which two timings count as even, so that queries
+# that call the same functors either way do not flip with noise.
+TOLERANCE = 0.05
+
+
+class Timing:
+    """The median and the standard deviation of a case, in ns."""
+
+    def __init__(self, ns, functors):
+        self.ns = ns
+        self.stddev = 0.0
+        self.functors = functors
+
+
+def load(path):
+    """Returns {variant: {query: {size: Timing}}} and the context."""
+    with open(path) as f:
+        data = json.load(f)
+    times = defaultdict(lambda: defaultdict(dict))
+    stddevs = {}
+    for run in data["benchmarks"]:
+        variant, query, size = run["name"].split("/")[:3]
+        key = (variant, query, int(size.split("_")[0]))
+        ns = run["real_time"] * TO_NS[run["time_unit"]]
+        kind = run.get("aggregate_name", "iteration")
+        if kind in ("iteration", "median"):
+            # The median of the repetitions replaces the first of them.
+            if kind == "median" or key[2] not in times[variant][query]:
+                times[variant][query][key[2]] = Timing(ns,
+                                                       run.get("functors"))
+        elif kind == "stddev":
+            stddevs[key] = ns
+    for (variant, query, size), stddev in stddevs.items():
+        times[variant][query][size].stddev = stddev
+    data["context"]["repetitions"] = max(
+        run.get("repetitions", 1) for run in data["benchmarks"])
+    return times, data["context"]
+
+
+def fmt_ns(ns):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if abs(ns) >= scale:
+            return f"{ns / scale:.3g} {unit}"
+    return f"{ns:.3g} ns"
+
+
+def fmt_timing(timing):
+    return f"{fmt_ns(timing.ns)} ± {fmt_ns(timing.stddev)}"
+
+
+def is_even(timing, baseline):
+    slack = max(baseline.ns * TOLERANCE, timing.stddev + baseline.stddev)
+    return timing.ns <= baseline.ns + slack
+
+
+def break_even(evaluator, by_hand):
+    sizes = sorted(set(evaluator) & set(by_hand))
+    first = None
+    for size in sizes:
+        if is_even(evaluator[size], by_hand[size]):
+            first = size if first is None else first
+        else:
+            first = None
+    if first is None:
+        return "never"
+    return "always" if first == sizes[0] else str(first)
+
+
+def report(times, context):
+    evaluator, parallel, by_hand, fused = (
+        times[v] for v in ("Evaluator", "Parallel", "ByHand", "Fused"))
+    sizes = sorted({size for query in evaluator.values() for size in query})
+    smallest, largest = sizes[0], sizes[-1]
+    lines = [
+        f"Host: {context.get('num_cpus')} CPU at {context.get('mhz_per_cpu')} "
+        f"MHz, library build type {context.get('library_build_type')}, "
+        f"sizes {smallest} to {largest}, "
+        f"{context['repetitions']} repetitions.",
+        "",
+        "## Per query",
+        "",
+        "Functors called by Evaluator and by hand, the break-even size of "
+        f"Evaluator against calls by hand (within {TOLERANCE:.0%} or the "
+        "standard deviations of the two), and median time relative to both "
+        "baselines (below 1 means Evaluator is faster), and of Evaluator on a "
+        "ThreadPool relative to Evaluator.",
+        "",
+        f"| query | functors (Evaluator / by hand) | break-even "
+        f"| vs by hand at {smallest} | vs by hand at {largest} "
+        f"| vs fused at {smallest} | vs fused at {largest} "
+        f"| parallel at {smallest} | parallel at {largest} |",
+        "|---|---:|---:|---:|---:|---:|---:|---:|---:|",
+    ]
+    for query in sorted(evaluator, key=lambda q: (q.count("+"), q)):
+        e, p = evaluator[query], parallel[query]
+        h, f = by_hand[query], fused[query]
+        lines.append(
+            f"| {query} "
+            f"| {e[smallest].functors:.0f} / {h[smallest].functors:.0f} "
+            f"| {break_even(e, h)} "
+            f"| {e[smallest].ns / h[smallest].ns:.2f} "
+            f"| {e[largest].ns / h[largest].ns:.2f} "
+            f"| {e[smallest].ns / f[smallest].ns:.2f} "
+            f"| {e[largest].ns / f[largest].ns:.2f} "
+            f"| {p[smallest].ns / e[smallest].ns:.2f} "
+            f"| {p[largest].ns / e[largest].ns:.2f} |")
+    lines += [
+        "",
+        "## Dispatch overhead",
+        "",
+        f"Evaluator minus by hand at size {smallest}, where both call the "
+        "same functor once, as median ± standard deviation.",
+        "",
+        "| query | Evaluator | by hand | overhead |",
+        "|---|---:|---:|---:|",
+    ]
+    for query in ("Min", "Max", "Avg", "Var"):
+        e, h = evaluator[query][smallest], by_hand[query][smallest]
+        lines.append(f"| {query} | {fmt_timing(e)} | {fmt_timing(h)} "
+                     f"| {fmt_ns(e.ns - h.ns)} |")
+    lines += [
+        "",
+        "## Copy overhead",
+        "",
+        "Moves of the result of GetSorted into and out of the result buffer, "
+        "alone. Evaluator minus by hand for Sorted is not reported, as the "
+        "sort dominates both, and their difference is noise.",
+        "",
+        "| size | moves | per element |",
+        "|---:|---:|---:|",
+    ]
+    for size in sizes:
+        copy = times["Copy"]["Sorted"][size].ns
+        lines.append(f"| {size} | {fmt_ns(copy)} | {fmt_ns(copy / size)} |")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("results", help="--benchmark_out of bench_runtime")
+    parser.add_argument("--output", help="also write the report to this file")
+    args = parser.parse_args()
+
+    lines = report(*load(args.results))
+    print("\n".join(lines))
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+
+if __name__ == "__main__":
+    main()
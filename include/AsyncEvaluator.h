@@ -0,0 +1,319 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "AsyncEvaluator.h requires C++20 coroutines."
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "Evaluator.h"
+
+namespace set_cover {
+
+template <typename tValue> class Task;
+
+namespace async_impl {
+
+template <typename tValue> struct TaskPromiseBase {
+  void return_value(tValue aValue) { mValue.emplace(std::move(aValue)); }
+
+  tValue take() { return std::move(*mValue); }
+
+  std::optional<tValue> mValue;
+};
+
+template <> struct TaskPromiseBase<void> {
+  void return_void() {}
+
+  void take() {}
+};
+
+// A coroutine that starts at once and destroys itself when done, so that
+// nobody awaits it.
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+// Counts the awaitables of a wave that are still pending, plus one for the
+// coroutine that awaits the wave, which is resumed by whoever counts last.
+// Keeps the first exception that the wave threw.
+class WaveLatch {
+public:
+  void add() { mCount.fetch_add(1, std::memory_order_relaxed); }
+
+  void fail(std::exception_ptr aError) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (!mError) {
+      mError = aError;
+    }
+  }
+
+  void arrive() {
+    if (mCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      mWaiter.resume();
+    }
+  }
+
+  bool await_ready() const noexcept {
+    return mCount.load(std::memory_order_acquire) == 1;
+  }
+
+  bool await_suspend(std::coroutine_handle<> aWaiter) noexcept {
+    mWaiter = aWaiter;
+    return mCount.fetch_sub(1, std::memory_order_acq_rel) != 1;
+  }
+
+  void await_resume() const {
+    if (mError) {
+      std::rethrow_exception(mError);
+    }
+  }
+
+private:
+  std::atomic<std::size_t> mCount = 1;
+  std::coroutine_handle<> mWaiter;
+  std::mutex mMutex;
+  std::exception_ptr mError;
+};
+
+template <typename tValue> struct IsTuple : public std::false_type {};
+
+template <typename... tValues>
+struct IsTuple<std::tuple<tValues...>> : public std::true_type {};
+
+} // namespace async_impl
+
+// A coroutine that returns tValue. It starts when it is awaited, and resumes
+// its awaiter where it finishes, which may be on another thread.
+template <typename tValue> class [[nodiscard]] Task {
+public:
+  struct promise_type : public async_impl::TaskPromiseBase<tValue> {
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    auto final_suspend() noexcept {
+      struct Resume {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_type> aSelf) noexcept {
+          return aSelf.promise().mAwaiter;
+        }
+        void await_resume() noexcept {}
+      };
+      return Resume{};
+    }
+
+    void unhandled_exception() { mError = std::current_exception(); }
+
+    std::coroutine_handle<> mAwaiter = std::noop_coroutine();
+    std::exception_ptr mError;
+  };
+
+  Task(Task &&aOther) noexcept
+      : mHandle(std::exchange(aOther.mHandle, nullptr)) {}
+
+  Task &operator=(Task aOther) noexcept {
+    std::swap(mHandle, aOther.mHandle);
+    return *this;
+  }
+
+  ~Task() {
+    if (mHandle) {
+      mHandle.destroy();
+    }
+  }
+
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<>
+  await_suspend(std::coroutine_handle<> aAwaiter) noexcept {
+    mHandle.promise().mAwaiter = aAwaiter;
+    return mHandle;
+  }
+
+  tValue await_resume() {
+    if (mHandle.promise().mError) {
+      std::rethrow_exception(mHandle.promise().mError);
+    }
+    return mHandle.promise().take();
+  }
+
+private:
+  explicit Task(std::coroutine_handle<promise_type> aHandle)
+      : mHandle(aHandle) {}
+
+  std::coroutine_handle<promise_type> mHandle;
+};
+
+namespace async_impl {
+
+inline Detached signalWhenDone(Task<void> &aTask, std::exception_ptr &aError,
+                               std::mutex &aMutex,
+                               std::condition_variable &aDone,
+                               bool &aIsDone) {
+  try {
+    co_await aTask;
+  } catch (...) {
+    aError = std::current_exception();
+  }
+  std::lock_guard<std::mutex> lock(aMutex);
+  aIsDone = true;
+  aDone.notify_one();
+}
+
+inline void wait(Task<void> &aTask) {
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable done;
+  bool isDone = false;
+  signalWhenDone(aTask, error, mutex, done, isDone);
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&isDone] { return isDone; });
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+template <typename tValue>
+Task<void> storeInto(Task<tValue> &aTask, std::optional<tValue> &aValue) {
+  aValue.emplace(co_await aTask);
+}
+
+} // namespace async_impl
+
+// Runs aTask, and blocks the calling thread until it is done.
+template <typename tValue> tValue syncWait(Task<tValue> aTask) {
+  if constexpr (std::is_void_v<tValue>) {
+    async_impl::wait(aTask);
+  } else {
+    std::optional<tValue> value;
+    Task<void> store = async_impl::storeInto(aTask, value);
+    async_impl::wait(store);
+    return std::move(*value);
+  }
+}
+
+// An Evaluator whose functors may return an awaitable of their results, such
+// as a Task, instead of the results themselves, e.g. to read them from disk.
+// evalAsync calls the functors of each wave of the plan (see Plan) one after
+// another. Those that return their results are done then, and the awaitables
+// that the others return are awaited concurrently, each moving its results
+// into place as it completes. The next wave starts once the whole wave is
+// done, on the thread that completed it last.
+//
+// Functors that return awaitables are not timed (see LogTiming).
+template <typename tUniverse, typename tPolicy, typename... tFunctors>
+class AsyncEvaluator : public Evaluator<tUniverse, tPolicy, tFunctors...> {
+  using Base = Evaluator<tUniverse, tPolicy, tFunctors...>;
+
+  template <std::size_t tI, typename tPlan, typename tBufferList,
+            typename tBuffer, typename tAwaitable>
+  static async_impl::Detached await(async_impl::WaveLatch &aLatch,
+                                    tBuffer &aBuffer, tAwaitable aAwaitable) {
+    using IthFunctor = typename Base::template FunctorAt<tPlan, tI>;
+    try {
+      auto src = co_await std::move(aAwaitable);
+      scatter(aBuffer, std::move(src),
+              std::make_index_sequence<std::tuple_size_v<decltype(src)>>{},
+              typename IthFunctor::EvalList{},
+              typename tPlan::template OwnedList<tI, tBufferList>{});
+    } catch (...) {
+      aLatch.fail(std::current_exception());
+    }
+    aLatch.arrive();
+  }
+
+  // Runs the tI-th functor of tPlan inline, or starts awaiting what it
+  // returns.
+  template <std::size_t tI, typename tPlan, typename tBufferList,
+            typename tBuffer, typename... tArgs>
+  void start(async_impl::WaveLatch &aLatch, tBuffer &aBuffer,
+             tArgs &...aArgs) {
+    using IthFunctor = typename Base::template FunctorAt<tPlan, tI>;
+    using InputList = typename Base::template InputList<IthFunctor>;
+    try {
+      if constexpr (Base::template writesInPlace<IthFunctor, tArgs...>(
+                        typename IthFunctor::EvalList{}, InputList{})) {
+        Base::template evalFunctor<tI, tPlan, tBufferList>(*this, aBuffer,
+                                                           aArgs...);
+      } else {
+        auto call = [&] {
+          return Base::template call<IthFunctor, tBufferList>(
+              *this, this->template getFunctor<IthFunctor>(), aBuffer,
+              InputList{}, aArgs...);
+        };
+        if constexpr (async_impl::IsTuple<decltype(call())>::value) {
+          auto src = this->template measure<IthFunctor, tPlan, tI>(call);
+          scatter(aBuffer, std::move(src),
+                  std::make_index_sequence<std::tuple_size_v<decltype(src)>>{},
+                  typename IthFunctor::EvalList{},
+                  typename tPlan::template OwnedList<tI, tBufferList>{});
+        } else {
+          aLatch.add();
+          await<tI, tPlan, tBufferList>(aLatch, aBuffer, call());
+        }
+      }
+    } catch (...) {
+      aLatch.fail(std::current_exception());
+    }
+  }
+
+  template <typename tPlan, typename tBufferList, typename tBuffer,
+            std::size_t... tIs, typename... tArgs>
+  Task<void> runWave(tBuffer &aBuffer, std::index_sequence<tIs...>,
+                     tArgs &...aArgs) {
+    async_impl::WaveLatch latch;
+    (start<tIs, tPlan, tBufferList>(latch, aBuffer, aArgs...), ...);
+    co_await latch;
+  }
+
+  template <typename tPlan, typename tBufferList, typename tBuffer,
+            std::size_t... tLevels, std::size_t... tIs, typename... tArgs>
+  Task<void> runWaves(tBuffer &aBuffer, std::index_sequence<tLevels...>,
+                      std::index_sequence<tIs...>, tArgs &...aArgs) {
+    (co_await runWave<tPlan, tBufferList>(
+         aBuffer, typename tPlan::template Wave<tLevels>{}, aArgs...),
+     ...);
+    (this->log(typeid(typename Base::template FunctorAt<tPlan, tIs>)), ...);
+  }
+
+public:
+  using Base::Base;
+
+  // Like eval, as a Task, which owns copies of aArgs; pass std::cref to
+  // share them instead. The evaluator must outlive the task, and must not
+  // run another eval until the task is done.
+  template <typename... tEvaluables, typename... tArgs>
+  Task<std::tuple<typename tEvaluables::Type...>> evalAsync(tArgs... aArgs) {
+    using MyPlan = typename Base::template Plan<
+        typename tUniverse::template Set<tEvaluables...>>;
+    using BufferList = typename Base::template BufferListOf<tEvaluables...>;
+    this->clearLog();
+    decltype(Base::makeBuffer(BufferList{})) buffer;
+    co_await runWaves<MyPlan, BufferList>(
+        buffer, std::make_index_sequence<MyPlan::kLevelCount>{},
+        std::make_index_sequence<MyPlan::kSize>{}, aArgs...);
+    co_return Base::template unwrap<tEvaluables...>(
+        buffer, std::index_sequence_for<tEvaluables...>{});
+  }
+};
+
+} // namespace set_cover
@@ -1,13 +1,29 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
+#include "Execution.h"
 #include "MinSetCover.h"
 #include "TupleUtil.h"
 #include "TypeMap.h"
@@ -17,12 +33,401 @@ namespace set_cover {
 
 using GreedyMinSetCover = MinSetCover<Greedy<TightestOneWins>>;
 
+// Greedy, minus the picks that later picks made redundant.
+using DefaultMinSetCover =
+    MinSetCover<ReverseDelete<Greedy<TightestOneWins>>>;
+
+// Makes Evaluator::evalMask answer every set of evaluables that its functors
+// compute.
+struct AllQueries {};
+
+// Each of these sets instantiates a set cover and an eval, so AllQueries is
+// only allowed when the functors compute few evaluables.
+constexpr std::size_t kMaxAllQueriesElements = 10;
+
+// Each subset of a query instantiates a set cover and an eval in
+// CachingEvaluator, so only small queries are cached.
+constexpr std::size_t kMaxCachedQueryElements = 10;
+
 namespace evaluator_impl {
-template <typename... tEvaluables>
-auto makeEvalType(std::tuple<tEvaluables...>)
-    -> std::tuple<typename tEvaluables::Type...>;
+// Not a flag index, so that it is never found in a list of them.
+constexpr std::size_t kNobody = std::numeric_limits<std::size_t>::max();
+
+template <typename tSet> constexpr bool contains(std::size_t aFlagIndex) {
+  return (word<tSet>(aFlagIndex / kWordBits) >> (aFlagIndex % kWordBits)) & 1;
+}
+
+// Index of the first set of tMinSetCover that holds the element, so that the
+// element is written by that functor only.
+template <std::size_t tFlagIndex, typename... tSets>
+constexpr std::size_t ownerOf(std::tuple<tSets...> *) {
+  constexpr bool holds[] = {contains<tSets>(tFlagIndex)..., false};
+  for (std::size_t i = 0; i < sizeof...(tSets); ++i) {
+    if (holds[i]) {
+      return i;
+    }
+  }
+  return kNobody;
+}
+
+// tQueryList, with the elements that the tI-th functor does not own replaced
+// by kNobody.
+template <std::size_t tI, typename tMinSetCover, std::size_t... tFlagIndices>
+auto ownedBy(std::index_sequence<tFlagIndices...>) -> std::index_sequence<(
+    ownerOf<tFlagIndices>(static_cast<tMinSetCover *>(nullptr)) == tI
+        ? tFlagIndices
+        : kNobody)...>;
+
+// A list of flag indices, such as the whole universe, with the elements that
+// tQuerySet does not hold replaced by kNobody.
+template <typename tQuerySet, std::size_t... tFlagIndices>
+auto spreadOver(std::index_sequence<tFlagIndices...>)
+    -> std::index_sequence<(contains<tQuerySet>(tFlagIndices) ? tFlagIndices
+                                                              : kNobody)...>;
+
+template <typename tFunctor, typename = void> struct InputListOf {
+  using Type = std::index_sequence<>;
+};
+
+template <typename tFunctor>
+struct InputListOf<tFunctor, std::void_t<typename tFunctor::InputList>> {
+  using Type = typename tFunctor::InputList;
+};
+
+// Levels of the functors of a cover, such that each functor only reads
+// elements owned by functors of lower levels, given the words of the outputs
+// and of the inputs of each functor. All levels are kNobody if the inputs
+// form a cycle.
+template <std::size_t tN, std::size_t tW>
+constexpr std::array<std::size_t, tN>
+levels(const std::array<std::array<std::size_t, tW>, tN> &aOutputs,
+       const std::array<std::array<std::size_t, tW>, tN> &aInputs) {
+  std::array<std::array<bool, tN>, tN> reads = {};
+  for (std::size_t i = 0; i < tN; ++i) {
+    for (std::size_t w = 0; w < tW; ++w) {
+      for (std::size_t b = 0; b < kWordBits; ++b) {
+        if (!((aInputs[i][w] >> b) & 1)) {
+          continue;
+        }
+        std::size_t owner = 0;
+        while (owner < tN && !((aOutputs[owner][w] >> b) & 1)) {
+          ++owner;
+        }
+        if (owner < tN) {
+          reads[i][owner] = true;
+        }
+      }
+    }
+  }
+  // A level that reaches tN is on a cycle.
+  std::array<std::size_t, tN> levels = {};
+  for (std::size_t round = 0; round <= tN; ++round) {
+    for (std::size_t i = 0; i < tN; ++i) {
+      for (std::size_t j = 0; j < tN; ++j) {
+        if (reads[i][j] && levels[i] < levels[j] + 1) {
+          levels[i] = levels[j] + 1;
+        }
+      }
+    }
+  }
+  for (std::size_t i = 0; i < tN; ++i) {
+    if (levels[i] >= tN) {
+      for (std::size_t &level : levels) {
+        level = kNobody;
+      }
+    }
+  }
+  return levels;
+}
+
+// tList without kNobody.
+template <std::size_t... tIs, std::size_t... tJs>
+auto dropNobody(std::index_sequence<tIs...>, std::index_sequence<tJs...>) {
+  constexpr auto kept = [] {
+    std::array<std::size_t, sizeof...(tJs)> kept = {};
+    std::size_t n = 0;
+    ((tIs == kNobody ? void() : void(kept[n++] = tIs)), ...);
+    return kept;
+  }();
+  return std::index_sequence<kept[tJs]...>();
+}
+
+template <std::size_t... tIs>
+auto dropNobody(std::index_sequence<tIs...> aList)
+    -> decltype(dropNobody(
+        aList, std::make_index_sequence<((tIs != kNobody) + ... + 0)>{}));
+
+template <std::size_t... tIs>
+constexpr std::array<std::size_t, sizeof...(tIs)> kPositions = {tIs...};
+
+template <std::size_t... tIs, std::size_t... tJs>
+auto concat(std::index_sequence<tIs...>, std::index_sequence<tJs...>)
+    -> std::index_sequence<tIs..., tJs...>;
+
+// The elements of tList at the bits set in tPicks, as the words of a set.
+template <std::size_t tPicks, typename tList> struct PickWords;
+
+template <std::size_t tPicks, std::size_t... tFlagIndices>
+struct PickWords<tPicks, std::index_sequence<tFlagIndices...>> {
+  static constexpr std::size_t kCount = [] {
+    std::size_t count = 1;
+    ((count = tFlagIndices / kWordBits < count ? count
+                                               : tFlagIndices / kWordBits + 1),
+     ...);
+    return count;
+  }();
+  static constexpr auto kValue = [] {
+    std::array<std::size_t, kCount> words = {};
+    std::size_t n = 0;
+    (((tPicks >> n++) & 1
+          ? void(words[tFlagIndices / kWordBits] |=
+                 std::size_t{1} << (tFlagIndices % kWordBits))
+          : void()),
+     ...);
+    return words;
+  }();
+};
+
+template <typename... tElements>
+auto makeMaskResult(std::tuple<tElements...>)
+    -> std::tuple<std::optional<typename tElements::Type>...>;
+
+// The queries that Evaluator::evalMask answers, as sets, indexed from 0 to
+// kSize. find maps a mask to its index, or to kNobody. tReachable is the mask
+// of the evaluables that some functor computes.
+template <typename tQueries, std::size_t tReachable> struct QueryTable;
+
+// The bits of aBits that are set in aMask, packed into the lowest bits.
+constexpr std::size_t extractBits(std::size_t aBits, std::size_t aMask) {
+  std::size_t packed = 0;
+  std::size_t n = 0;
+  for (std::size_t b = 0; b < kWordBits; ++b) {
+    if ((aMask >> b) & 1) {
+      packed |= ((aBits >> b) & 1) << n++;
+    }
+  }
+  return packed;
+}
+
+// The inverse of extractBits.
+constexpr std::size_t depositBits(std::size_t aPacked, std::size_t aMask) {
+  std::size_t bits = 0;
+  std::size_t n = 0;
+  for (std::size_t b = 0; b < kWordBits; ++b) {
+    if ((aMask >> b) & 1) {
+      bits |= ((aPacked >> n++) & 1) << b;
+    }
+  }
+  return bits;
+}
+
+// Every subset of the reachable evaluables, indexed by its mask with the
+// unreachable bits taken out.
+template <std::size_t tReachable> struct QueryTable<AllQueries, tReachable> {
+  static constexpr std::size_t kReachableCount =
+      type_set_impl::popCount(tReachable);
+
+  static_assert(kReachableCount <= kMaxAllQueriesElements,
+                "Declare the queries of universes this large.");
+
+  static constexpr std::size_t kSize = std::size_t{1} << kReachableCount;
+
+  template <std::size_t tI>
+  using QuerySetAt =
+      std::integral_constant<std::size_t, depositBits(tI, tReachable)>;
+
+  static constexpr std::size_t find(std::size_t aMask) {
+    return (aMask & ~tReachable) == 0 ? extractBits(aMask, tReachable)
+                                      : kNobody;
+  }
+};
+
+// Sorted by mask, and found by binary search.
+template <typename... tQuerySets, std::size_t tReachable>
+struct QueryTable<std::tuple<tQuerySets...>, tReachable> {
+  static_assert(((wordCount<tQuerySets>() == 1) && ...),
+                "Queries must fit in a mask.");
+
+  static constexpr std::size_t kSize = sizeof...(tQuerySets);
+
+  // Indices of tQuerySets in the order of their masks.
+  static constexpr std::array<std::size_t, kSize> kOrder = [] {
+    std::array<std::size_t, kSize> order = {};
+    const std::size_t masks[] = {word<tQuerySets>(0)..., 0};
+    for (std::size_t i = 0; i < kSize; ++i) {
+      std::size_t j = i;
+      for (; j > 0 && masks[order[j - 1]] > masks[i]; --j) {
+        order[j] = order[j - 1];
+      }
+      order[j] = i;
+    }
+    return order;
+  }();
+
+  template <std::size_t tI>
+  using QuerySetAt = ElementAt<kOrder[tI], tQuerySets...>;
+
+  static constexpr std::array<std::size_t, kSize> kMasks = [] {
+    const std::size_t masks[] = {word<tQuerySets>(0)..., 0};
+    std::array<std::size_t, kSize> sorted = {};
+    for (std::size_t i = 0; i < kSize; ++i) {
+      sorted[i] = masks[kOrder[i]];
+    }
+    return sorted;
+  }();
+
+  static_assert(
+      [] {
+        for (std::size_t i = 1; i < kSize; ++i) {
+          if (kMasks[i - 1] == kMasks[i]) {
+            return false;
+          }
+        }
+        return true;
+      }(),
+      "Queries are declared twice.");
+
+  static constexpr std::size_t find(std::size_t aMask) {
+    std::size_t begin = 0;
+    std::size_t end = kSize;
+    while (begin < end) {
+      const std::size_t middle = begin + (end - begin) / 2;
+      if (kMasks[middle] < aMask) {
+        begin = middle + 1;
+      } else {
+        end = middle;
+      }
+    }
+    return begin < kSize && kMasks[begin] == aMask ? begin : kNobody;
+  }
+};
+
+template <typename tFunctor, typename = void>
+struct HasState : public std::false_type {};
+
+template <typename tFunctor>
+struct HasState<tFunctor, std::void_t<typename tFunctor::State>>
+    : public std::true_type {};
+
+template <typename tNamed, typename = void>
+struct HasName : public std::false_type {};
+
+template <typename tNamed>
+struct HasName<tNamed, std::void_t<decltype(tNamed::name)>>
+    : public std::true_type {};
+
+template <typename tPolicy, typename = void>
+struct HasLogSpan : public std::false_type {};
+
+template <typename tPolicy>
+struct HasLogSpan<tPolicy, std::void_t<decltype(&tPolicy::logSpan)>>
+    : public std::true_type {};
+
+template <typename tPolicy, typename = void>
+struct HasLogCall : public std::false_type {};
+
+template <typename tPolicy>
+struct HasLogCall<tPolicy, std::void_t<decltype(&tPolicy::logCall)>>
+    : public std::true_type {};
+
+template <typename tPolicy, typename = void>
+struct HasResizeLog : public std::false_type {};
+
+template <typename tPolicy>
+struct HasResizeLog<tPolicy, std::void_t<decltype(&tPolicy::resizeLog)>>
+    : public std::true_type {};
+
+// How many functors tPolicy can log, which it declares as kLogCapacity if its
+// storage is fixed.
+template <typename tPolicy, typename = void> struct LogCapacityOf {
+  static constexpr std::size_t kValue = std::numeric_limits<std::size_t>::max();
+};
+
+template <typename tPolicy>
+struct LogCapacityOf<tPolicy, std::void_t<decltype(tPolicy::kLogCapacity)>> {
+  static constexpr std::size_t kValue = tPolicy::kLogCapacity;
+};
+
+template <typename tValue, typename = void>
+struct IsContiguous : public std::false_type {};
+
+template <typename tValue>
+struct IsContiguous<tValue,
+                    std::void_t<decltype(std::declval<tValue>().data()),
+                                decltype(std::declval<tValue>().size())>>
+    : public std::true_type {};
+
+// The size of aValue, plus that of the elements it holds if it is a
+// contiguous container.
+template <typename tValue> std::size_t bytesOf(const tValue &aValue) {
+  if constexpr (IsContiguous<tValue>::value) {
+    return sizeof(tValue) + aValue.size() * sizeof(*aValue.data());
+  } else {
+    return sizeof(tValue);
+  }
+}
+
+template <typename... tValues>
+std::size_t bytesOf(const std::tuple<tValues...> &aValues) {
+  return std::apply(
+      [](const tValues &...aValue) {
+        return (std::size_t{0} + ... + bytesOf(aValue));
+      },
+      aValues);
+}
+
+// A result of evalInto, in storage of the caller.
+template <typename tValue> class OutputSlot {
+public:
+  explicit OutputSlot(tValue &aTarget) : mTarget(&aTarget) {}
+
+  tValue &operator*() const { return *mTarget; }
+
+  OutputSlot &operator=(tValue &&aValue) {
+    *mTarget = std::move(aValue);
+    return *this;
+  }
+
+private:
+  tValue *mTarget;
+};
+
+// Where a functor that writes in place writes a result: a fresh value in a
+// buffer of eval, or the storage of the caller, as it is, in one of evalInto.
+template <typename tValue> tValue &slot(std::optional<tValue> &aSlot) {
+  return aSlot.emplace();
 }
 
+template <typename tValue> tValue &slot(const OutputSlot<tValue> &aSlot) {
+  return *aSlot;
+}
+
+template <typename tPolicy, typename = void>
+struct HasExecution : public std::false_type {};
+
+template <typename tPolicy>
+struct HasExecution<tPolicy, std::void_t<typename tPolicy::ExecutionPolicy>>
+    : public std::true_type {};
+
+template <typename tPolicy, typename = void>
+struct HasMemoryResource : public std::false_type {};
+
+template <typename tPolicy>
+struct HasMemoryResource<tPolicy,
+                         std::void_t<typename tPolicy::MemoryResourcePolicy>>
+    : public std::true_type {};
+
+template <typename tPolicy, typename = void> struct MinSetCoverOf {
+  using Type = DefaultMinSetCover;
+};
+
+template <typename tPolicy>
+struct MinSetCoverOf<tPolicy,
+                     std::void_t<typename tPolicy::MinSetCoverPolicy>> {
+  using Type = typename tPolicy::MinSetCoverPolicy;
+};
+} // namespace evaluator_impl
+
 class LogNothing {
 public:
   using Log = void;
@@ -43,45 +448,1473 @@ private:
   Log mLog;
 };
 
-template <typename tUniverse, typename tLogPolicy, typename... tFunctors>
-struct Evaluator : public tLogPolicy {
+// Times each functor call, and adds the results up across evals until
+// resetLog. Functors are found by their position among the functors of the
+// Evaluator, in storage that the Evaluator sizes by resizeLog when it is
+// constructed, so that logging never allocates. Concurrent functors never log
+// into the same FunctorLog.
+class LogTiming {
+public:
+  // Latencies are counted in buckets of powers of two nanoseconds: bucket b
+  // counts calls that took less than 2^b ns, and at least 2^(b-1) ns. The last
+  // bucket counts all longer calls.
+  static constexpr std::size_t kBucketCount = 32;
+
+  struct FunctorLog {
+    std::size_t mCalls = 0;
+    std::chrono::nanoseconds mTotal{0};
+    std::size_t mBytes = 0;
+    std::array<std::size_t, kBucketCount> mBuckets = {};
+
+    // The least power of two nanoseconds that aFraction of calls took less
+    // than, or that the last bucket starts at.
+    std::chrono::nanoseconds percentile(double aFraction) const {
+      const double target = aFraction * mCalls;
+      std::size_t count = 0;
+      for (std::size_t b = 0; b + 1 < kBucketCount; ++b) {
+        count += mBuckets[b];
+        if (count >= target) {
+          return std::chrono::nanoseconds(std::int64_t{1} << b);
+        }
+      }
+      return std::chrono::nanoseconds(std::int64_t{1} << (kBucketCount - 2));
+    }
+  };
+
+  using Log = std::vector<FunctorLog>;
+
+  static std::size_t bucketOf(std::chrono::nanoseconds aElapsed) {
+    std::size_t bucket = 0;
+    for (auto ns = aElapsed.count(); ns > 0 && bucket + 1 < kBucketCount;
+         ns >>= 1) {
+      ++bucket;
+    }
+    return bucket;
+  }
+
+  void clearLog() {}
+  void log(const std::type_info &aFunctor) {}
+  void logCall(std::size_t aFunctorIndex, std::chrono::nanoseconds aElapsed,
+               std::size_t aBytes) {
+    FunctorLog &log = mLog[aFunctorIndex];
+    ++log.mCalls;
+    log.mTotal += aElapsed;
+    log.mBytes += aBytes;
+    ++log.mBuckets[bucketOf(aElapsed)];
+  }
+  const Log &getLog() const { return mLog; }
+  void resetLog() { mLog.assign(mLog.size(), FunctorLog()); }
+  void resizeLog(std::size_t aFunctorCount) { mLog.resize(aFunctorCount); }
+
+private:
+  Log mLog;
+};
+
+// The counters of LogTiming as atomics, which any number of threads add to
+// without locks, for up to kCapacity functors. Each FunctorLog has a cache
+// line of its own, so that threads that run different functors do not
+// contend.
+class SharedTiming {
+public:
+  static constexpr std::size_t kCapacity = kWordBits;
+
+  void logCall(std::size_t aFunctorIndex, std::chrono::nanoseconds aElapsed,
+               std::size_t aBytes) {
+    FunctorLog &log = mLogs[aFunctorIndex];
+    log.mCalls.fetch_add(1, std::memory_order_relaxed);
+    log.mTotal.fetch_add(aElapsed.count(), std::memory_order_relaxed);
+    log.mBytes.fetch_add(aBytes, std::memory_order_relaxed);
+    log.mBuckets[LogTiming::bucketOf(aElapsed)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+
+  // The counters of the first aFunctorCount functors so far. Calls that are
+  // logged meanwhile may be counted in some of them only.
+  LogTiming::Log snapshot(std::size_t aFunctorCount) const {
+    LogTiming::Log snapshot(aFunctorCount);
+    for (std::size_t i = 0; i < aFunctorCount; ++i) {
+      const FunctorLog &log = mLogs[i];
+      snapshot[i].mCalls = log.mCalls.load(std::memory_order_relaxed);
+      snapshot[i].mTotal = std::chrono::nanoseconds(
+          log.mTotal.load(std::memory_order_relaxed));
+      snapshot[i].mBytes = log.mBytes.load(std::memory_order_relaxed);
+      for (std::size_t b = 0; b < LogTiming::kBucketCount; ++b) {
+        snapshot[i].mBuckets[b] =
+            log.mBuckets[b].load(std::memory_order_relaxed);
+      }
+    }
+    return snapshot;
+  }
+
+  void reset() {
+    for (FunctorLog &log : mLogs) {
+      log.mCalls.store(0, std::memory_order_relaxed);
+      log.mTotal.store(0, std::memory_order_relaxed);
+      log.mBytes.store(0, std::memory_order_relaxed);
+      for (std::atomic<std::size_t> &bucket : log.mBuckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+
+private:
+  struct alignas(64) FunctorLog {
+    std::atomic<std::size_t> mCalls{0};
+    std::atomic<std::int64_t> mTotal{0};
+    std::atomic<std::size_t> mBytes{0};
+    std::array<std::atomic<std::size_t>, LogTiming::kBucketCount> mBuckets =
+        {};
+  };
+
+  std::array<FunctorLog, kCapacity> mLogs;
+};
+
+// Like LogTiming, but logs into one SharedTiming per tTag, which all
+// evaluators with this policy share, whichever thread they run on, so that
+// each thread may run an evaluator of its own and the counts still add up.
+// clearLog does nothing, as no evaluator owns the counters. Functors are
+// found by their position, so evaluators that share a tag should have the
+// same functors, and at most kLogCapacity of them.
+template <typename tTag = void> class LogSharedTiming {
+public:
+  using Log = LogTiming::Log;
+  static constexpr std::size_t kLogCapacity = SharedTiming::kCapacity;
+
+  static SharedTiming &sharedTiming() {
+    static SharedTiming timing;
+    return timing;
+  }
+
+  void clearLog() {}
+  void log(const std::type_info &aFunctor) {}
+  void logCall(std::size_t aFunctorIndex, std::chrono::nanoseconds aElapsed,
+               std::size_t aBytes) {
+    sharedTiming().logCall(aFunctorIndex, aElapsed, aBytes);
+  }
+  Log getLog() const { return sharedTiming().snapshot(mFunctorCount); }
+  void resetLog() { sharedTiming().reset(); }
+  void resizeLog(std::size_t aFunctorCount) { mFunctorCount = aFunctorCount; }
+
+private:
+  std::size_t mFunctorCount = 0;
+};
+
+// The name that a functor or an evaluable declares
+// (`static constexpr char name[] = "...";`), or else the name of its type,
+// which the compiler may mangle.
+template <typename tNamed> const char *nameOf() {
+  if constexpr (evaluator_impl::HasName<tNamed>::value) {
+    return tNamed::name;
+  } else {
+    return typeid(tNamed).name();
+  }
+}
+
+// A plan of an Evaluator as data: the functors that it calls, by position in
+// the Evaluator, in the order that the set cover picked them. For each, the
+// wave that it runs in, its cost (see costOf), and the words of the set of
+// evaluables that it computes first among the ones the plan needs.
+template <std::size_t tSize, std::size_t tWordCount> struct PlanInfo {
+  std::array<std::size_t, tSize> mFunctors;
+  std::array<std::size_t, tSize> mLevels;
+  std::array<std::size_t, tSize> mCosts;
+  std::array<std::array<std::size_t, tWordCount>, tSize> mCovered;
+
+  constexpr std::size_t size() const { return tSize; }
+
+  constexpr std::size_t cost() const {
+    std::size_t cost = 0;
+    for (std::size_t functorCost : mCosts) {
+      cost += functorCost;
+    }
+    return cost;
+  }
+};
+
+// Positions of evaluables in a universe, or of functors in an Evaluator, in
+// static storage.
+class PositionList {
+public:
+  template <std::size_t... tIs>
+  explicit PositionList(std::index_sequence<tIs...>)
+      : mBegin(evaluator_impl::kPositions<tIs...>.data()),
+        mEnd(mBegin + sizeof...(tIs)) {}
+
+  const std::size_t *begin() const { return mBegin; }
+  const std::size_t *end() const { return mEnd; }
+  std::size_t size() const { return mEnd - mBegin; }
+
+private:
+  const std::size_t *mBegin;
+  const std::size_t *mEnd;
+};
+
+// A functor call, with the plan it was part of.
+struct Span {
+  const char *mFunctor;
+  // Position of the functor in the Evaluator.
+  std::size_t mFunctorIndex;
+  // The wave of the plan that the call ran in.
+  std::size_t mLevel;
+  // The evaluables that the plan was made for.
+  PositionList mQuery;
+  // The evaluables that were at hand already, as in CachingEvaluator.
+  PositionList mAvailable;
+  // The functors that the plan runs.
+  PositionList mCover;
+  // The evaluables that the plan needs and that this call computes first.
+  PositionList mCovered;
+  std::thread::id mThread;
+  std::chrono::steady_clock::time_point mStart;
+  std::chrono::nanoseconds mDuration;
+};
+
+// Keeps a Span per functor call, and adds them up across evals until
+// resetLog. writeChromeTrace writes them as Chrome trace events, which
+// chrome://tracing and Perfetto show on a timeline. A policy with a logSpan
+// of its own may forward spans to another tracer instead.
+class LogTrace {
+public:
+  using Log = std::vector<Span>;
+
+  void clearLog() {}
+  void log(const std::type_info &aFunctor) {}
+  void logSpan(const Span &aSpan) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLog.push_back(aSpan);
+  }
+  Log getLog() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLog;
+  }
+  void resetLog() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mLog.clear();
+  }
+
+  // Writes one complete event per span, with times relative to the first of
+  // them, and the plan as arguments.
+  void writeChromeTrace(std::ostream &aOut) const {
+    const Log log = getLog();
+    std::vector<std::thread::id> threads;
+    auto origin = log.empty() ? std::chrono::steady_clock::time_point()
+                              : log.front().mStart;
+    for (const Span &span : log) {
+      origin = std::min(origin, span.mStart);
+    }
+    aOut << "{\"traceEvents\":[";
+    for (const Span &span : log) {
+      const std::size_t thread =
+          std::find(threads.begin(), threads.end(), span.mThread) -
+          threads.begin();
+      if (thread == threads.size()) {
+        threads.push_back(span.mThread);
+      }
+      aOut << (&span == &log.front() ? "\n" : ",\n") << "{\"name\":\"";
+      for (const char *c = span.mFunctor; *c; ++c) {
+        aOut << (*c == '"' || *c == '\\' ? "\\" : "") << *c;
+      }
+      aOut << "\",\"cat\":\"set_cover\",\"ph\":\"X\",\"pid\":0,\"tid\":"
+           << thread << ",\"ts\":" << microseconds(span.mStart - origin)
+           << ",\"dur\":" << microseconds(span.mDuration)
+           << ",\"args\":{\"functor\":" << span.mFunctorIndex
+           << ",\"level\":" << span.mLevel << ",\"query\":";
+      writeList(aOut, span.mQuery);
+      aOut << ",\"available\":";
+      writeList(aOut, span.mAvailable);
+      aOut << ",\"cover\":";
+      writeList(aOut, span.mCover);
+      aOut << ",\"covered\":";
+      writeList(aOut, span.mCovered);
+      aOut << "}}";
+    }
+    aOut << "\n]}\n";
+  }
+
+private:
+  static std::string microseconds(std::chrono::nanoseconds aTime) {
+    const std::string fraction = std::to_string(1000 + aTime.count() % 1000);
+    return std::to_string(aTime.count() / 1000) + "." + fraction.substr(1);
+  }
+
+  static void writeList(std::ostream &aOut, const PositionList &aList) {
+    aOut << "[";
+    for (const std::size_t &position : aList) {
+      aOut << (&position == aList.begin() ? "" : ",") << position;
+    }
+    aOut << "]";
+  }
+
+  mutable std::mutex mMutex;
+  Log mLog;
+};
+
+// Makes Evaluator solve set cover with tMinSetCover instead of
+// DefaultMinSetCover. Logging is left to tLogPolicy.
+template <typename tMinSetCover, typename tLogPolicy = LogNothing>
+struct WithMinSetCover : public tLogPolicy {
+  using MinSetCoverPolicy = tMinSetCover;
+  using tLogPolicy::tLogPolicy;
+};
+
+// Makes Evaluator run the functors of a cover with tExecution (see
+// Execution.h) instead of one after another. Everything else is left to
+// tPolicy.
+//
+// The policy owns a default-constructed tExecution, unless tExecution is a
+// reference, such as ThreadPool &, to an execution policy owned elsewhere and
+// passed to the Evaluator constructor. Evaluators can then share one
+// ThreadPool of a chosen size:
+//
+//   ThreadPool pool(2);
+//   Evaluator<U, WithExecution<ThreadPool &>, GetMin, GetMax> e(pool);
+template <typename tExecution, typename tPolicy = LogNothing>
+struct WithExecution : public tPolicy {
+  using ExecutionPolicy = std::remove_reference_t<tExecution>;
+
+  WithExecution() = default;
+
+  explicit WithExecution(ExecutionPolicy &aExecution)
+      : mExecution(aExecution) {}
+
+  ExecutionPolicy &getExecution() { return mExecution; }
+
+private:
+  tExecution mExecution;
+};
+
+// Makes Evaluator pass tResource, which is a std::pmr::memory_resource, to the
+// functors that take FromResource, instead of the default resource.
+// releaseMemory frees everything that they allocated from it at once, when
+// tResource supports it, as std::pmr::monotonic_buffer_resource does in O(1).
+// Their results must not be used afterwards. When functors run concurrently
+// (see WithExecution), tResource must be thread-safe, such as
+// std::pmr::synchronized_pool_resource.
+template <typename tResource = std::pmr::monotonic_buffer_resource,
+          typename tPolicy = LogNothing>
+struct WithMemoryResource : public tPolicy {
+  using MemoryResourcePolicy = tResource;
+  using tPolicy::tPolicy;
+  tResource &getMemoryResource() { return mResource; }
+  void releaseMemory() { mResource.release(); }
+
+private:
+  tResource mResource;
+};
+
+// Passed first to a functor that allocates its results from mResource (see
+// WithMemoryResource), as allocator-aware types such as std::pmr::vector.
+struct FromResource {
+  std::pmr::memory_resource *mResource;
+};
+
+// Passed first to a functor that evaluates a whole batch of inputs in one
+// call (see Evaluator::evalBatch).
+struct InBatch {};
+
+// Passed first to a functor that writes its results into references to them,
+// in the order of its EvalList, which come before the arguments of eval
+// (see Evaluator::evalInto).
+struct InPlace {};
+
+// tPolicy provides logging (see LogNothing and LogTypeIndex), may pick the set
+// cover algorithm by declaring MinSetCoverPolicy (see WithMinSetCover), and
+// may run functors concurrently by declaring ExecutionPolicy (see
+// WithExecution), and may give functors that take FromResource a memory
+// resource by declaring MemoryResourcePolicy (see WithMemoryResource).
+// Functors are logged once all of them are done, so that logging needs no
+// synchronization.
+//
+// The evaluator owns one instance of each functor, default-constructed or
+// passed to its constructor, and calls it by reference in every eval, so that
+// a functor may keep scratch buffers or tables across calls. Concurrent
+// functors are distinct instances, but evals on the same evaluator must not
+// overlap, so threads should each have an evaluator of their own (see
+// LogSharedTiming for adding up their timings).
+//
+// A functor may declare an InputList of evaluables that it takes after the
+// arguments of eval (see InputList). The evaluator then covers these inputs as
+// well, and runs the functors that compute them first, once per eval.
+//
+// A functor may declare its cost (see costOf) so that a weighted algorithm can
+// prefer cheap functors over ones that merely cover more.
+//
+// A functor may take InBatch (see evalBatch) to evaluate many inputs at once,
+// or InPlace (see evalInto) to write its results into storage that it is
+// given instead of returning them.
+template <typename tUniverse, typename tPolicy, typename... tFunctors>
+struct Evaluator : public tPolicy {
 
   template <typename tFunctor>
   using EvalSet = decltype(toSet(typename tFunctor::EvalList{}));
 
-  using FunctorByEvalSet = Map<MapItem<EvalSet<tFunctors>, tFunctors>...>;
+  template <typename tFunctor>
+  using Candidate = Costed<EvalSet<tFunctor>, tFunctor>;
+
+  using FunctorByCandidate = Map<MapItem<Candidate<tFunctors>, tFunctors>...>;
+
+  using MinSetCoverPolicy =
+      typename evaluator_impl::MinSetCoverOf<tPolicy>::Type;
+
+  template <typename tSet>
+  using CoverOf = decltype(MinSetCoverPolicy::template eval<
+                           tSet, Candidate<tFunctors>...>());
+
+  // Evaluables that tFunctor takes after the arguments of eval, in this order.
+  template <typename tFunctor>
+  using InputList = typename evaluator_impl::InputListOf<tFunctor>::Type;
+
+  template <typename tFunctor>
+  using InputSet = decltype(toSet(InputList<tFunctor>{}));
+
+  // Results of evalMask: the whole universe in canonical order, with only the
+  // queried evaluables engaged.
+  using MaskResult = decltype(evaluator_impl::makeMaskResult(
+      typename tUniverse::AsTuple{}));
 
 protected:
-  template <size_t tI, typename tMinSetCover, typename... tArgs>
-  auto sparseEval(tArgs &&...aArgs)
-      -> decltype(evaluator_impl::makeEvalType(typename tUniverse::AsTuple{})) {
-    if constexpr (tI == std::tuple_size_v<tMinSetCover>) {
-      return {};
+  static constexpr std::size_t kElementCount =
+      std::tuple_size_v<typename tUniverse::AsTuple>;
+
+  template <typename... tCandidates>
+  static auto inputsOf(std::tuple<tCandidates...> *) -> SetUnion<
+      InputSet<typename FunctorByCandidate::template Find<tCandidates>>...>;
+
+  // Inputs of the cover of tSet that neither tSet nor tAvailable hold.
+  template <typename tSet, typename tAvailable>
+  using MissingInputs =
+      SetMinus<SetMinus<decltype(inputsOf(
+                            static_cast<CoverOf<tSet> *>(nullptr))),
+                        tSet>,
+               tAvailable>;
+
+  // The smallest superset of tSet whose cover computes its own inputs, but
+  // those of tAvailable.
+  template <typename tSet, typename tAvailable,
+            bool tClosed = isEmpty<MissingInputs<tSet, tAvailable>>()>
+  struct ClosureOf {
+    using Type = typename ClosureOf<
+        SetUnion<tSet, MissingInputs<tSet, tAvailable>>, tAvailable>::Type;
+  };
+
+  template <typename tSet, typename tAvailable>
+  struct ClosureOf<tSet, tAvailable, true> {
+    using Type = tSet;
+  };
+
+  // The functors that evaluate tQuerySet, and the level of each (see
+  // evaluator_impl::levels). Functors of one level run together, after all
+  // functors of lower levels. Inputs in tAvailable are read from the buffer
+  // instead of being computed.
+  template <typename tQuerySet, typename tAvailable = SetUnion<>> struct Plan {
+    using QuerySet = tQuerySet;
+    using AvailableSet = tAvailable;
+    using RequiredSet = typename ClosureOf<tQuerySet, tAvailable>::Type;
+    using Cover = CoverOf<RequiredSet>;
+    static constexpr std::size_t kSize = std::tuple_size_v<Cover>;
+
+    template <typename... tCandidates>
+    static constexpr auto levelsOf(std::tuple<tCandidates...> *) {
+      constexpr std::size_t kW = maxWordCount<
+          tCandidates...,
+          InputSet<typename FunctorByCandidate::template Find<
+              tCandidates>>...>();
+      return evaluator_impl::levels<kSize, kW>(
+          {words<kW, tCandidates>()...},
+          {words<kW, InputSet<typename FunctorByCandidate::template Find<
+                         tCandidates>>>()...});
+    }
+
+    static constexpr std::array<std::size_t, kSize> kLevels =
+        levelsOf(static_cast<Cover *>(nullptr));
+
+    static_assert(kSize == 0 || kLevels[0] != evaluator_impl::kNobody,
+                  "Functor inputs form a cycle.");
+
+    static constexpr std::size_t kLevelCount = [] {
+      std::size_t count = 0;
+      for (std::size_t level : kLevels) {
+        count = level + 1 > count ? level + 1 : count;
+      }
+      return count;
+    }();
+
+    static constexpr std::size_t waveSize(std::size_t aLevel) {
+      std::size_t size = 0;
+      for (std::size_t level : kLevels) {
+        size += level == aLevel;
+      }
+      return size;
+    }
+
+    template <std::size_t tLevel, std::size_t... tJs>
+    static auto wave(std::index_sequence<tJs...>) {
+      constexpr auto indices = [] {
+        std::array<std::size_t, sizeof...(tJs)> indices = {};
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < kSize; ++i) {
+          if (kLevels[i] == tLevel) {
+            indices[n++] = i;
+          }
+        }
+        return indices;
+      }();
+      return std::index_sequence<indices[tJs]...>();
+    }
+
+    // Indices in Cover of the functors of level tLevel.
+    template <std::size_t tLevel>
+    using Wave =
+        decltype(wave<tLevel>(std::make_index_sequence<waveSize(tLevel)>{}));
+
+    // tBufferList, with the evaluables that the tI-th functor does not write
+    // replaced by kNobody: those of RequiredSet that it does not own, and all
+    // others, which the plan either reads or does not need.
+    template <std::size_t tI, typename tBufferList>
+    using OwnedList = decltype(evaluator_impl::ownedBy<tI, Cover>(
+        evaluator_impl::spreadOver<RequiredSet>(tBufferList{})));
+  };
+
+  template <std::size_t tFlagIndex>
+  using TypeAt =
+      typename std::tuple_element_t<tFlagIndex,
+                                    typename tUniverse::AsTuple>::Type;
+
+  // Inputs that the plan of tEvaluables needs beyond them.
+  template <typename... tEvaluables>
+  using UnqueriedListOf = decltype(toCanonicalList<SetMinus<
+      typename Plan<typename tUniverse::template Set<tEvaluables...>>::
+          RequiredSet,
+      typename tUniverse::template Set<tEvaluables...>>>());
+
+  // What eval of tEvaluables holds: the queried evaluables first, then the
+  // inputs that are not queried.
+  template <typename... tEvaluables>
+  using BufferListOf = decltype(evaluator_impl::concat(
+      typename tUniverse::template KPerm<tEvaluables...>{},
+      UnqueriedListOf<tEvaluables...>{}));
+
+  // Holds the evaluables at tFlagIndices, so that nothing else is ever
+  // constructed.
+  template <std::size_t... tFlagIndices>
+  static auto makeBuffer(std::index_sequence<tFlagIndices...>)
+      -> std::tuple<std::optional<TypeAt<tFlagIndices>>...>;
+
+  // Holds one column per evaluable at tFlagIndices, for evalBatch.
+  template <std::size_t... tFlagIndices>
+  static auto makeColumns(std::index_sequence<tFlagIndices...>)
+      -> std::tuple<std::vector<TypeAt<tFlagIndices>>...>;
+
+  // Whether aFunctor takes tParams, with or without FromResource first.
+  template <typename tFunctor, typename... tParams>
+  static constexpr bool takes() {
+    return std::is_invocable_v<tFunctor &, tParams...> ||
+           std::is_invocable_v<tFunctor &, FromResource, tParams...>;
+  }
+
+  // Calls aFunctor on aParams, and on FromResource first if it takes it,
+  // which every path that calls functors goes through.
+  template <typename tFunctor, typename... tParams>
+  static decltype(auto) invoke(Evaluator &aSelf, tFunctor &aFunctor,
+                               tParams &&...aParams) {
+    if constexpr (std::is_invocable_v<tFunctor &, FromResource, tParams...>) {
+      return aFunctor(FromResource{&aSelf.memoryResource()},
+                      std::forward<tParams>(aParams)...);
+    } else {
+      return aFunctor(std::forward<tParams>(aParams)...);
+    }
+  }
+
+  template <typename tFunctor, typename tBufferList, typename tBuffer,
+            std::size_t... tInputs, typename... tArgs>
+  static auto call(Evaluator &aSelf, tFunctor &aFunctor,
+                   const tBuffer &aBuffer, std::index_sequence<tInputs...>,
+                   tArgs &...aArgs) {
+    return invoke(
+        aSelf, aFunctor, aArgs...,
+        *std::get<tuple_util_impl::positionOf<tInputs>(tBufferList{})>(
+            aBuffer)...);
+  }
+
+  template <typename tFunctor, typename... tArgs, std::size_t... tOutputs,
+            std::size_t... tInputs>
+  static constexpr bool writesInPlace(std::index_sequence<tOutputs...>,
+                                      std::index_sequence<tInputs...>) {
+    return takes<tFunctor, InPlace, TypeAt<tOutputs> &..., tArgs &...,
+                 const TypeAt<tInputs> &...>();
+  }
+
+  // Where a functor writes the tJ-th evaluable of its EvalList, at
+  // tFlagIndex: its slot in aBuffer if it owns it there, or else aDiscarded.
+  template <std::size_t tJ, std::size_t tFlagIndex, typename tOwned,
+            typename tBuffer, typename tDiscarded>
+  static auto &outputAt(tBuffer &aBuffer, tDiscarded &aDiscarded) {
+    constexpr std::size_t kPosition =
+        tuple_util_impl::positionOf<tFlagIndex>(tOwned{});
+    if constexpr (kPosition < std::tuple_size_v<tBuffer>) {
+      return evaluator_impl::slot(std::get<kPosition>(aBuffer));
     } else {
-      using IthFunctor = typename FunctorByEvalSet::template Find<
-          std::tuple_element_t<tI, tMinSetCover>>;
-      auto src = IthFunctor{}(std::forward<tArgs>(aArgs)...);
-      this->log(typeid(IthFunctor));
-      auto tgt =
-          sparseEval<tI + 1, tMinSetCover>(std::forward<tArgs>(aArgs)...);
-      replace(tgt, src,
+      return evaluator_impl::slot(std::get<tJ>(aDiscarded));
+    }
+  }
+
+  // Calls a functor that writes in place, and returns its results.
+  template <typename tFunctor, typename tBufferList, typename tOwned,
+            typename tBuffer, typename tDiscarded, std::size_t... tJs,
+            std::size_t... tOutputs, std::size_t... tInputs,
+            typename... tArgs>
+  static auto callInPlace(Evaluator &aSelf, tFunctor &aFunctor,
+                          tBuffer &aBuffer, tDiscarded &aDiscarded,
+                          std::index_sequence<tJs...>,
+                          std::index_sequence<tOutputs...>,
+                          std::index_sequence<tInputs...>, tArgs &...aArgs) {
+    auto outputs = std::forward_as_tuple(
+        outputAt<tJs, tOutputs, tOwned>(aBuffer, aDiscarded)...);
+    invoke(aSelf, aFunctor, InPlace{}, std::get<tJs>(outputs)..., aArgs...,
+           *std::get<tuple_util_impl::positionOf<tInputs>(tBufferList{})>(
+               aBuffer)...);
+    return outputs;
+  }
+
+  // Moves the evaluables of tBufferList that the tI-th functor of the cover
+  // owns into aBuffer, so that each is written once, and concurrent functors
+  // never write the same one. The inputs of the functor come from aBuffer. A
+  // functor that writes in place writes into aBuffer directly, and the
+  // evaluables that it does not own into temporaries.
+  template <size_t tI, typename tPlan, typename tBufferList, typename tBuffer,
+            typename... tArgs>
+  static void evalFunctor(Evaluator &aSelf, tBuffer &aBuffer,
+                          tArgs &...aArgs) {
+    using IthFunctor = typename FunctorByCandidate::template Find<
+        std::tuple_element_t<tI, typename tPlan::Cover>>;
+    using EvalList = typename IthFunctor::EvalList;
+    using Owned = typename tPlan::template OwnedList<tI, tBufferList>;
+    IthFunctor &functor = aSelf.template getFunctor<IthFunctor>();
+    if constexpr (writesInPlace<IthFunctor, tArgs...>(
+                      EvalList{}, InputList<IthFunctor>{})) {
+      decltype(makeBuffer(EvalList{})) discarded;
+      aSelf.template measure<IthFunctor, tPlan, tI>([&] {
+        return callInPlace<IthFunctor, tBufferList, Owned>(
+            aSelf, functor, aBuffer, discarded,
+            std::make_index_sequence<EvalList::size()>{}, EvalList{},
+            InputList<IthFunctor>{}, aArgs...);
+      });
+    } else {
+      auto src = aSelf.template measure<IthFunctor, tPlan, tI>([&] {
+        return call<IthFunctor, tBufferList>(
+            aSelf, functor, aBuffer, InputList<IthFunctor>{}, aArgs...);
+      });
+      scatter(aBuffer, std::move(src),
               std::make_index_sequence<std::tuple_size_v<decltype(src)>>{},
-              typename IthFunctor::EvalList{});
-      return tgt;
+              EvalList{}, Owned{});
+    }
+  }
+
+  // Runs the tI-th functor of a cover once, on the arguments of eval.
+  struct SingleStep {
+    template <size_t tI, typename tPlan, typename tBufferList, typename tBuffer,
+              typename... tArgs>
+    static void run(Evaluator &aSelf, tBuffer &aBuffer, tArgs &...aArgs) {
+      evalFunctor<tI, tPlan, tBufferList>(aSelf, aBuffer, aArgs...);
+    }
+  };
+
+  template <typename tFunctor, typename tInputs, std::size_t... tInputIndices>
+  static constexpr bool takesBatch(std::index_sequence<tInputIndices...>) {
+    return takes<tFunctor, InBatch, const tInputs &,
+                 const std::vector<TypeAt<tInputIndices>> &...>();
+  }
+
+  template <typename tFunctor, typename tInput, std::size_t... tInputIndices>
+  static constexpr bool takesOne(std::index_sequence<tInputIndices...>) {
+    return takes<tFunctor, const tInput &, const TypeAt<tInputIndices> &...>();
+  }
+
+  template <typename tFunctor, typename tBufferList, typename tBuffer,
+            typename tInput, std::size_t... tInputs>
+  static auto callAt(Evaluator &aSelf, tFunctor &aFunctor,
+                     const tBuffer &aBuffer, [[maybe_unused]] std::size_t aI,
+                     const tInput &aInput, std::index_sequence<tInputs...>) {
+    return invoke(
+        aSelf, aFunctor, aInput,
+        std::get<tuple_util_impl::positionOf<tInputs>(tBufferList{})>(
+            aBuffer)[aI]...);
+  }
+
+  template <typename tFunctor, typename tBufferList, typename tBuffer,
+            typename tBatch, std::size_t... tInputs>
+  static auto callBatch(Evaluator &aSelf, tFunctor &aFunctor,
+                        const tBuffer &aBuffer, const tBatch &aBatch,
+                        std::index_sequence<tInputs...>) {
+    return invoke(
+        aSelf, aFunctor, InBatch{}, aBatch,
+        std::get<tuple_util_impl::positionOf<tInputs>(tBufferList{})>(
+            aBuffer)...);
+  }
+
+  template <typename tBuffer, std::size_t... tIs, std::size_t... tOwned>
+  static void reserve(tBuffer &aBuffer, std::size_t aSize,
+                      std::index_sequence<tIs...>,
+                      std::index_sequence<tOwned...>) {
+    ((tOwned == evaluator_impl::kNobody
+          ? void()
+          : std::get<tIs>(aBuffer).reserve(aSize)),
+     ...);
+  }
+
+  // Fills the columns of aBuffer that the tI-th functor of a cover owns, for
+  // each of aInputs. Functors that take InBatch are called once, with the
+  // columns of their inputs, and the others once per input.
+  struct BatchStep {
+    template <size_t tI, typename tPlan, typename tBufferList, typename tBuffer,
+              typename tInputs>
+    static void run(Evaluator &aSelf, tBuffer &aBuffer,
+                    const tInputs &aInputs) {
+      using IthFunctor = typename FunctorByCandidate::template Find<
+          std::tuple_element_t<tI, typename tPlan::Cover>>;
+      using Owned = typename tPlan::template OwnedList<tI, tBufferList>;
+      using Outputs = std::make_index_sequence<IthFunctor::EvalList::size()>;
+      IthFunctor &functor = aSelf.template getFunctor<IthFunctor>();
+      if constexpr (takesBatch<IthFunctor, tInputs>(
+                        InputList<IthFunctor>{})) {
+        auto src = aSelf.template measure<IthFunctor, tPlan, tI>([&] {
+          return callBatch<IthFunctor, tBufferList>(
+              aSelf, functor, aBuffer, aInputs, InputList<IthFunctor>{});
+        });
+        scatter(aBuffer, std::move(src), Outputs{},
+                typename IthFunctor::EvalList{}, Owned{});
+      } else {
+        static_assert(
+            takesOne<IthFunctor, std::decay_t<decltype(*std::begin(
+                                     std::declval<const tInputs &>()))>>(
+                InputList<IthFunctor>{}),
+            "evalBatch calls functors that neither take InBatch nor return "
+            "their results, such as ones that take InPlace only.");
+        reserve(aBuffer, std::size(aInputs),
+                std::make_index_sequence<std::tuple_size_v<tBuffer>>{},
+                Owned{});
+        std::size_t i = 0;
+        for (const auto &input : aInputs) {
+          auto src = aSelf.template measure<IthFunctor, tPlan, tI>([&] {
+            return callAt<IthFunctor, tBufferList>(
+                aSelf, functor, aBuffer, i, input, InputList<IthFunctor>{});
+          });
+          scatterBack(aBuffer, std::move(src), Outputs{},
+                      typename IthFunctor::EvalList{}, Owned{});
+          ++i;
+        }
+      }
     }
+  };
+
+  template <typename... tCandidates>
+  static auto functorList(std::tuple<tCandidates...> *) -> std::index_sequence<
+      flagIndex<typename FunctorByCandidate::template Find<tCandidates>,
+                tFunctors...>()...>;
+
+  template <typename tPlan, std::size_t tI>
+  using FunctorAt = typename FunctorByCandidate::template Find<
+      std::tuple_element_t<tI, typename tPlan::Cover>>;
+
+  // The evaluables that tPlan needs and that its tI-th functor computes
+  // first.
+  template <typename tPlan, std::size_t tI>
+  using CoveredList = decltype(evaluator_impl::dropNobody(
+      typename tPlan::template OwnedList<
+          tI, std::make_index_sequence<kElementCount>>{}));
+
+  // The call of tFunctor, the tI-th functor of tPlan, that started at aStart.
+  template <typename tFunctor, typename tPlan, std::size_t tI>
+  static Span spanOf(std::chrono::steady_clock::time_point aStart,
+                     std::chrono::nanoseconds aDuration) {
+    return {nameOf<tFunctor>(),
+            flagIndex<tFunctor, tFunctors...>(),
+            tPlan::kLevels[tI],
+            PositionList(toCanonicalList<typename tPlan::QuerySet>()),
+            PositionList(toCanonicalList<typename tPlan::AvailableSet>()),
+            PositionList(decltype(functorList(
+                static_cast<typename tPlan::Cover *>(nullptr))){}),
+            PositionList(CoveredList<tPlan, tI>{}),
+            std::this_thread::get_id(),
+            aStart,
+            aDuration};
+  }
+
+  // Returns what aCall returns, which are the results of tFunctor, the tI-th
+  // functor of tPlan. If tPolicy takes them, reports how long the call took
+  // and how large the results are (see LogTiming), or the call as a Span (see
+  // LogTrace).
+  template <typename tFunctor, typename tPlan, std::size_t tI, typename tCall>
+  auto measure(tCall &&aCall) {
+    constexpr bool kTimes = evaluator_impl::HasLogCall<tPolicy>::value;
+    constexpr bool kTraces = evaluator_impl::HasLogSpan<tPolicy>::value;
+    if constexpr (kTimes || kTraces) {
+      const auto start = std::chrono::steady_clock::now();
+      auto results = aCall();
+      const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start);
+      if constexpr (kTimes) {
+        this->logCall(flagIndex<tFunctor, tFunctors...>(), elapsed,
+                      evaluator_impl::bytesOf(results));
+      }
+      if constexpr (kTraces) {
+        this->logSpan(spanOf<tFunctor, tPlan, tI>(start, elapsed));
+      }
+      return results;
+    } else {
+      return aCall();
+    }
+  }
+
+  decltype(auto) execution() {
+    if constexpr (evaluator_impl::HasExecution<tPolicy>::value) {
+      return (this->getExecution());
+    } else {
+      return Sequential();
+    }
+  }
+
+  std::pmr::memory_resource &memoryResource() {
+    if constexpr (evaluator_impl::HasMemoryResource<tPolicy>::value) {
+      return this->getMemoryResource();
+    } else {
+      return *std::pmr::get_default_resource();
+    }
+  }
+
+  // Runs each functor of a wave by tStep (see SingleStep and BatchStep).
+  template <typename tPlan, typename tBufferList, typename tStep,
+            typename tBuffer, std::size_t... tIs, typename... tArgs>
+  void runWave(tBuffer &aBuffer, std::index_sequence<tIs...>,
+               tArgs &...aArgs) {
+    execution().run([this, &aBuffer, &aArgs...] {
+      tStep::template run<tIs, tPlan, tBufferList>(*this, aBuffer,
+                                                           aArgs...);
+    }...);
+  }
+
+  template <typename tPlan, typename tBufferList, typename tStep,
+            typename tBuffer, std::size_t... tLevels, std::size_t... tIs,
+            typename... tArgs>
+  void sparseEval(tBuffer &aBuffer, std::index_sequence<tLevels...>,
+                  std::index_sequence<tIs...>, tArgs &...aArgs) {
+    (runWave<tPlan, tBufferList, tStep>(
+         aBuffer, typename tPlan::template Wave<tLevels>{}, aArgs...),
+     ...);
+    (this->log(typeid(typename FunctorByCandidate::template Find<
+                      std::tuple_element_t<tIs, typename tPlan::Cover>>)),
+     ...);
+  }
+
+  template <typename tPlan, typename tBufferList,
+            typename tStep = SingleStep, typename tBuffer, typename... tArgs>
+  void sparseEval(tBuffer &aBuffer, tArgs &...aArgs) {
+    sparseEval<tPlan, tBufferList, tStep>(
+        aBuffer, std::make_index_sequence<tPlan::kLevelCount>{},
+        std::make_index_sequence<tPlan::kSize>{}, aArgs...);
+  }
+
+  template <typename tQuerySet, std::size_t... tFlagIndices>
+  static void keepQueried(MaskResult &aResult,
+                          std::index_sequence<tFlagIndices...>) {
+    ((evaluator_impl::contains<tQuerySet>(tFlagIndices)
+          ? void()
+          : std::get<tFlagIndices>(aResult).reset()),
+     ...);
+  }
+
+  template <typename tQuerySet, typename... tArgs>
+  static void evalPlanned(Evaluator &aSelf, MaskResult &aResult,
+                          tArgs &...aArgs) {
+    using MyPlan = Plan<tQuerySet>;
+    using BufferList =
+        decltype(evaluator_impl::spreadOver<typename MyPlan::RequiredSet>(
+            std::make_index_sequence<kElementCount>{}));
+    aSelf.template sparseEval<MyPlan, BufferList>(aResult, aArgs...);
+    keepQueried<tQuerySet>(aResult, std::make_index_sequence<kElementCount>{});
   }
 
+  using ReachableSet = SetUnion<EvalSet<tFunctors>...>;
+
+  template <typename tQueries>
+  using QueryTableOf =
+      evaluator_impl::QueryTable<tQueries, word<ReachableSet>(0)>;
+
+  // evalPlanned for each query of tQueries, in the order of QueryTableOf.
+  template <typename tQueries, typename... tArgs> struct PlannedEvals {
+    using Table = QueryTableOf<tQueries>;
+
+    template <std::size_t... tIs>
+    static constexpr auto make(std::index_sequence<tIs...>) {
+      using PlannedEval = void (*)(Evaluator &, MaskResult &, tArgs &...);
+      return std::array<PlannedEval, sizeof...(tIs)>{
+          &evalPlanned<typename Table::template QuerySetAt<tIs>,
+                       tArgs...>...};
+    }
+
+    static constexpr auto kValue =
+        make(std::make_index_sequence<Table::kSize>{});
+  };
+
+  template <typename... tCandidates>
+  static constexpr std::size_t functorMask(std::tuple<tCandidates...> *) {
+    static_assert(sizeof...(tFunctors) <= kWordBits);
+    return (std::size_t{0} | ... |
+            (std::size_t{1}
+             << flagIndex<typename FunctorByCandidate::template Find<
+                              tCandidates>,
+                          tFunctors...>()));
+  }
+
+  template <typename tQueries, std::size_t... tIs>
+  static constexpr std::array<std::size_t, sizeof...(tIs)>
+  functorMasks(std::index_sequence<tIs...>) {
+    using Table = QueryTableOf<tQueries>;
+    return {functorMask(
+        static_cast<typename Plan<typename Table::template QuerySetAt<
+            tIs>>::Cover *>(nullptr))...};
+  }
+
+  // Masks hold one word, and so only the first kWordBits evaluables of the
+  // universe. Beyond these, evalMask would take every evaluable for one that
+  // no functor computes.
+  static constexpr void assertMasksFit() {
+    static_assert(kElementCount <= kWordBits,
+                  "evalMask only covers universes of up to kWordBits "
+                  "evaluables.");
+  }
+
+  template <typename tQueries> static std::size_t find(std::size_t aMask) {
+    assertMasksFit();
+    const std::size_t i = QueryTableOf<tQueries>::find(aMask);
+    if (i == evaluator_impl::kNobody) {
+      throw std::invalid_argument("Query is not in the table.");
+    }
+    return i;
+  }
+
+  template <typename tQuerySet, std::size_t... tIs>
+  static constexpr auto planOfSet([[maybe_unused]] std::size_t aSizeHint,
+                                  std::index_sequence<tIs...>) {
+    using MyPlan = Plan<tQuerySet>;
+    constexpr std::size_t kW = wordCount<typename MyPlan::RequiredSet>();
+    return PlanInfo<MyPlan::kSize, kW>{
+        {flagIndex<FunctorAt<MyPlan, tIs>, tFunctors...>()...},
+        MyPlan::kLevels,
+        {costOf<FunctorAt<MyPlan, tIs>>(aSizeHint)...},
+        {words<kW, decltype(toSet(CoveredList<MyPlan, tIs>{}))>()...}};
+  }
+
+  template <typename tQuerySet>
+  static constexpr auto planOfSet(std::size_t aSizeHint) {
+    return planOfSet<tQuerySet>(
+        aSizeHint, std::make_index_sequence<Plan<tQuerySet>::kSize>{});
+  }
+
+  template <std::size_t... tFlagIndices>
+  static void writeQuery(std::ostream &aOut,
+                         std::index_sequence<tFlagIndices...>) {
+    if constexpr (sizeof...(tFlagIndices) == 0) {
+      aOut << "(none)";
+    }
+    std::size_t n = 0;
+    ((aOut << (n++ ? "+" : "")
+           << nameOf<std::tuple_element_t<tFlagIndices,
+                                          typename tUniverse::AsTuple>>()),
+     ...);
+  }
+
+  template <typename tQuerySet>
+  static void writePlan(std::ostream &aOut, std::size_t aSizeHint) {
+    const auto plan = planOfSet<tQuerySet>(aSizeHint);
+    aOut << "| ";
+    writeQuery(aOut, toCanonicalList<tQuerySet>());
+    aOut << " | ";
+    std::size_t written = 0;
+    for (std::size_t level = 0; written < plan.size(); ++level) {
+      aOut << (level ? " -> " : "");
+      for (std::size_t i = 0, n = 0; i < plan.size(); ++i) {
+        if (plan.mLevels[i] == level) {
+          aOut << (n++ ? ", " : "") << functorName(plan.mFunctors[i]);
+          ++written;
+        }
+      }
+    }
+    aOut << " | " << plan.size() << " | " << plan.cost() << " |\n";
+  }
+
+  template <typename tQueries, std::size_t... tIs>
+  static void writePlans(std::ostream &aOut, std::size_t aSizeHint,
+                         std::index_sequence<tIs...>) {
+    using Table = QueryTableOf<tQueries>;
+    (writePlan<typename Table::template QuerySetAt<tIs>>(aOut, aSizeHint),
+     ...);
+  }
+
+  template <typename... tEvaluables, typename tBuffer, std::size_t... tIs>
+  static std::tuple<typename tEvaluables::Type...>
+  unwrap(tBuffer &aBuffer, std::index_sequence<tIs...>) {
+    return {std::move(*std::get<tIs>(aBuffer))...};
+  }
+
+  // The union of the queries of evalFused.
+  template <typename... tQueryLists>
+  using FusedSet = SetUnion<decltype(toSet(tQueryLists{}))...>;
+
+  // Whether a query of tQueryLists after the tQuery-th holds tFlagIndex.
+  template <std::size_t tFlagIndex, std::size_t tQuery,
+            typename... tQueryLists>
+  static constexpr bool heldLater() {
+    constexpr bool holds[] = {
+        evaluator_impl::contains<decltype(toSet(tQueryLists{}))>(
+            tFlagIndex)...};
+    for (std::size_t i = tQuery + 1; i < sizeof...(tQueryLists); ++i) {
+      if (holds[i]) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // A result of the tQuery-th query of evalFused, which is copied out of
+  // aBuffer if a later query holds it too, and moved out otherwise.
+  template <std::size_t tFlagIndex, std::size_t tQuery, typename tBufferList,
+            typename... tQueryLists, typename tBuffer>
+  static TypeAt<tFlagIndex> takeResult(tBuffer &aBuffer) {
+    auto &result =
+        *std::get<tuple_util_impl::positionOf<tFlagIndex>(tBufferList{})>(
+            aBuffer);
+    if constexpr (heldLater<tFlagIndex, tQuery, tQueryLists...>()) {
+      return result;
+    } else {
+      return std::move(result);
+    }
+  }
+
+  template <std::size_t tQuery, typename tBufferList,
+            typename... tQueryLists, typename tBuffer,
+            std::size_t... tFlagIndices>
+  static std::tuple<TypeAt<tFlagIndices>...>
+  resultsOf(tBuffer &aBuffer, std::index_sequence<tFlagIndices...>) {
+    return {takeResult<tFlagIndices, tQuery, tBufferList, tQueryLists...>(
+        aBuffer)...};
+  }
+
+  // The results of each of tQueryLists, taken in order, so that the last
+  // query that holds a result gets it moved.
+  template <typename tBufferList, typename... tQueryLists, typename tBuffer,
+            std::size_t... tQueries>
+  static auto resultsOfEach(tBuffer &aBuffer,
+                            std::index_sequence<tQueries...>) {
+    return std::tuple<decltype(resultsOf<tQueries, tBufferList,
+                                         tQueryLists...>(
+        aBuffer, tQueryLists{}))...>{
+        resultsOf<tQueries, tBufferList, tQueryLists...>(aBuffer,
+                                                         tQueryLists{})...};
+  }
+
+  template <typename... tEvaluables, typename tColumns, std::size_t... tIs>
+  static std::tuple<std::vector<typename tEvaluables::Type>...>
+  unwrapColumns(tColumns &aColumns, std::index_sequence<tIs...>) {
+    return {std::move(std::get<tIs>(aColumns))...};
+  }
+
+  // Lets the policy allocate what it logs per functor (see LogTiming).
+  void allocateLog() {
+    static_assert(sizeof...(tFunctors) <=
+                      evaluator_impl::LogCapacityOf<tPolicy>::kValue,
+                  "The policy cannot log this many functors.");
+    if constexpr (evaluator_impl::HasResizeLog<tPolicy>::value) {
+      tPolicy::resizeLog(sizeof...(tFunctors));
+    }
+  }
+
+  // Whether tInstances are one instance of each functor, in order. Compared
+  // as tuples, as packs of different lengths do not expand together.
+  template <typename... tInstances>
+  static constexpr bool kAreFunctors =
+      std::is_same_v<std::tuple<std::decay_t<tInstances>...>,
+                     std::tuple<tFunctors...>>;
+
 public:
+  Evaluator() { allocateLog(); }
+
+  // Calls copies of aFunctors instead of default-constructed ones.
+  template <typename... tInstances,
+            typename = std::enable_if_t<sizeof...(tInstances) != 0 &&
+                                        kAreFunctors<tInstances...>>>
+  explicit Evaluator(tInstances &&...aFunctors)
+      : mFunctors(std::forward<tInstances>(aFunctors)...) {
+    allocateLog();
+  }
+
+  // Passes aExecution to the policy, such as a ThreadPool owned elsewhere to
+  // WithExecution<ThreadPool &>, and calls copies of aFunctors, if any.
+  template <typename tExecution, typename... tInstances,
+            typename = std::enable_if_t<
+                std::is_constructible_v<tPolicy, tExecution &> &&
+                (sizeof...(tInstances) == 0 || kAreFunctors<tInstances...>)>>
+  explicit Evaluator(tExecution &aExecution, tInstances &&...aFunctors)
+      : tPolicy(aExecution),
+        mFunctors(std::forward<tInstances>(aFunctors)...) {
+    allocateLog();
+  }
+
+  template <typename tFunctor> tFunctor &getFunctor() {
+    return std::get<tFunctor>(mFunctors);
+  }
+
   template <typename... tEvaluables, typename... Args>
   auto eval(Args &&...aArgs) {
-    using MyEvalSet = typename tUniverse::template Set<tEvaluables...>;
-    using MyMinSetCover =
-        decltype(GreedyMinSetCover::eval<MyEvalSet, EvalSet<tFunctors>...>());
+    using MyPlan = Plan<typename tUniverse::template Set<tEvaluables...>>;
+    using BufferList = BufferListOf<tEvaluables...>;
     this->clearLog();
-    auto resultTuple =
-        sparseEval<0, MyMinSetCover>(std::forward<Args>(aArgs)...);
-    using QueryOrder = typename tUniverse::template KPerm<tEvaluables...>;
-    return reorder(resultTuple, QueryOrder{});
+    decltype(makeBuffer(BufferList{})) buffer;
+    sparseEval<MyPlan, BufferList>(buffer, aArgs...);
+    return unwrap<tEvaluables...>(buffer,
+                                  std::index_sequence_for<tEvaluables...>{});
+  }
+
+  // Like eval, for several queries at once, each a KPerm of the universe. The
+  // cover is found for the union of the queries, so that each functor runs
+  // once however many queries need it. Returns a tuple of results per query,
+  // in order. Evaluables that several queries hold are copied into each but
+  // the last, into which they are moved.
+  template <typename... tQueryLists, typename... tArgs>
+  auto evalFused(tArgs &&...aArgs) {
+    using MyPlan = Plan<FusedSet<tQueryLists...>>;
+    using BufferList =
+        decltype(toCanonicalList<typename MyPlan::RequiredSet>());
+    this->clearLog();
+    decltype(makeBuffer(BufferList{})) buffer;
+    sparseEval<MyPlan, BufferList>(buffer, aArgs...);
+    return resultsOfEach<BufferList, tQueryLists...>(
+        buffer, std::index_sequence_for<tQueryLists...>{});
+  }
+
+  // Like eval, but writes the results into aOutputs, in the order of
+  // tEvaluables, instead of returning them. Functors that write in place
+  // (see InPlace) are given aOutputs as they are, so that repeated evals into
+  // the same outputs can reuse their storage. The results of the other
+  // functors are moved into aOutputs.
+  template <typename... tEvaluables, typename... tArgs>
+  void evalInto(typename tEvaluables::Type &...aOutputs, tArgs &&...aArgs) {
+    using MyPlan = Plan<typename tUniverse::template Set<tEvaluables...>>;
+    using BufferList = BufferListOf<tEvaluables...>;
+    this->clearLog();
+    auto buffer = std::tuple_cat(
+        std::make_tuple(
+            evaluator_impl::OutputSlot<typename tEvaluables::Type>(
+                aOutputs)...),
+        decltype(makeBuffer(UnqueriedListOf<tEvaluables...>{})){});
+    sparseEval<MyPlan, BufferList>(buffer, aArgs...);
+  }
+
+  // Like eval, for each of aInputs, which is a range of the single argument
+  // that eval would take. Results are returned as one column per evaluable,
+  // in the order of aInputs. The cover is found once for the whole batch, and
+  // each of its functors either takes InBatch, aInputs, and the columns of
+  // its inputs, and returns a column per evaluable of its EvalList, or is
+  // called once per input. Functors that only write in place (see InPlace)
+  // cannot be batched.
+  template <typename... tEvaluables, typename tInputs>
+  std::tuple<std::vector<typename tEvaluables::Type>...>
+  evalBatch(const tInputs &aInputs) {
+    using MyPlan = Plan<typename tUniverse::template Set<tEvaluables...>>;
+    using BufferList = BufferListOf<tEvaluables...>;
+    this->clearLog();
+    decltype(makeColumns(BufferList{})) columns;
+    sparseEval<MyPlan, BufferList, BatchStep>(columns, aInputs);
+    return unwrapColumns<tEvaluables...>(
+        columns, std::index_sequence_for<tEvaluables...>{});
+  }
+
+  // The plan of eval<tEvaluables...> as data (see PlanInfo), with costs for
+  // an input of size aSizeHint, so that it can be checked at compile time.
+  template <typename... tEvaluables>
+  static constexpr auto planOf(std::size_t aSizeHint = 1) {
+    return planOfSet<typename tUniverse::template Set<tEvaluables...>>(
+        aSizeHint);
+  }
+
+  static const char *functorName(std::size_t aFunctorIndex) {
+    static const char *const kNames[] = {nameOf<tFunctors>()...};
+    return kNames[aFunctorIndex];
+  }
+
+  // Writes the plans of tQueries (see evalMask) as a Markdown table, with one
+  // row per query: its functors, wave after wave, how many there are, and
+  // what they cost for an input of size aSizeHint.
+  template <typename tQueries = AllQueries>
+  static void writePlans(std::ostream &aOut, std::size_t aSizeHint = 1) {
+    assertMasksFit();
+    aOut << "| query | functors | calls | cost |\n|---|---|---:|---:|\n";
+    writePlans<tQueries>(
+        aOut, aSizeHint,
+        std::make_index_sequence<QueryTableOf<tQueries>::kSize>{});
+  }
+
+  // The mask of the evaluables at aIndices in the universe.
+  template <typename tIndices>
+  static std::size_t toMask(const tIndices &aIndices) {
+    assertMasksFit();
+    std::size_t mask = 0;
+    for (std::size_t index : aIndices) {
+      if (index >= kElementCount) {
+        throw std::invalid_argument("Evaluable is not in the universe.");
+      }
+      mask |= std::size_t{1} << index;
+    }
+    return mask;
+  }
+
+  static std::size_t toMask(std::initializer_list<std::size_t> aIndices) {
+    return toMask<std::initializer_list<std::size_t>>(aIndices);
+  }
+
+  // The functors that evalMask calls for aMask, as a mask over tFunctors.
+  template <typename tQueries = AllQueries>
+  static std::size_t coverOf(std::size_t aMask) {
+    static constexpr auto kCovers = functorMasks<tQueries>(
+        std::make_index_sequence<QueryTableOf<tQueries>::kSize>{});
+    return kCovers[find<tQueries>(aMask)];
+  }
+
+  // Like eval, for a query that is only known at run time, as the mask of its
+  // evaluables over the universe (see toMask). The covers of tQueries, either
+  // AllQueries for every set of evaluables that the functors compute, or a
+  // std::tuple of the Sets that may be queried, are found at compile time, so
+  // that dispatch only looks up aMask in a table. Throws std::invalid_argument
+  // for a mask that is not in the table. A mask is one word, so evalMask only
+  // compiles for universes of up to kWordBits evaluables.
+  template <typename tQueries = AllQueries, typename... tArgs>
+  MaskResult evalMask(std::size_t aMask, tArgs &&...aArgs) {
+    assertMasksFit();
+    const auto planned =
+        PlannedEvals<tQueries, std::remove_reference_t<tArgs>...>::kValue
+            [find<tQueries>(aMask)];
+    this->clearLog();
+    MaskResult result;
+    planned(*this, result, aArgs...);
+    return result;
+  }
+
+private:
+  std::tuple<tFunctors...> mFunctors;
+};
+
+// An Evaluator that keeps what it computes across evals on the same input.
+// Each eval runs the cover of the queried evaluables that are not cached yet
+// only, reads the inputs of its functors from the cache where it can, and
+// caches what it was queried for and the inputs that it computed. The cover
+// of each subset of a query is found at compile time, and the one to run is
+// looked up by which evaluables are cached. evalMask is not cached.
+//
+// The cache is only valid for one input, and must be dropped when it changes,
+// either by invalidate or by setVersion.
+template <typename tUniverse, typename tPolicy, typename... tFunctors>
+class CachingEvaluator : public Evaluator<tUniverse, tPolicy, tFunctors...> {
+  using Base = Evaluator<tUniverse, tPolicy, tFunctors...>;
+  using Cache = typename Base::MaskResult;
+
+public:
+  using Base::Base;
+
+private:
+
+  // Runs the cover of tSet, reading its inputs of tAvailable from the cache,
+  // and caches the results that tSet needs. Cached results are never
+  // written again, so references to them stay valid.
+  template <typename tSet, typename tAvailable, typename... tArgs>
+  static void fill(CachingEvaluator &aSelf, tArgs &...aArgs) {
+    aSelf.template sparseEval<typename Base::template Plan<tSet, tAvailable>,
+                              std::make_index_sequence<Base::kElementCount>>(
+        aSelf.mCache, aArgs...);
+  }
+
+  // fill for each subset of tSet, given that the rest of tSet is cached,
+  // indexed by the mask of the elements of toCanonicalList<tSet> that the
+  // subset holds.
+  template <typename tSet, typename... tArgs> struct Fills {
+    using List = decltype(toCanonicalList<tSet>());
+
+    template <std::size_t tPicks>
+    using Subset = MakeSet<evaluator_impl::PickWords<tPicks, List>>;
+
+    template <std::size_t... tPicks>
+    static constexpr auto make(std::index_sequence<tPicks...>) {
+      using Fill = void (*)(CachingEvaluator &, tArgs &...);
+      return std::array<Fill, sizeof...(tPicks)>{
+          &fill<Subset<tPicks>, SetMinus<tSet, Subset<tPicks>>,
+                tArgs...>...};
+    }
+
+    static constexpr auto kValue =
+        make(std::make_index_sequence<std::size_t{1} << size<tSet>()>{});
+  };
+
+  // The mask of the elements of a list that are not cached.
+  template <std::size_t... tFlagIndices>
+  std::size_t missing(std::index_sequence<tFlagIndices...>) const {
+    std::size_t picks = 0;
+    std::size_t n = 0;
+    ((picks |= std::size_t{!std::get<tFlagIndices>(mCache).has_value()}
+               << n++),
+     ...);
+    return picks;
+  }
+
+  template <typename... tEvaluables, std::size_t... tFlagIndices>
+  std::tuple<const typename tEvaluables::Type &...>
+  view(std::index_sequence<tFlagIndices...>) const {
+    return {*std::get<tFlagIndices>(mCache)...};
+  }
+
+public:
+  // Like Evaluator::eval, but returns references into the cache, which stay
+  // valid until the cache is dropped.
+  template <typename... tEvaluables, typename... tArgs>
+  std::tuple<const typename tEvaluables::Type &...> eval(tArgs &&...aArgs) {
+    using QueryList = typename tUniverse::template KPerm<tEvaluables...>;
+    // The query and the inputs that its covers need.
+    using ClosedSet = typename Base::template ClosureOf<
+        typename tUniverse::template Set<tEvaluables...>, SetUnion<>>::Type;
+    static_assert(size<ClosedSet>() <= kMaxCachedQueryElements,
+                  "Queries this large cannot be cached.");
+    const auto fill =
+        Fills<ClosedSet, std::remove_reference_t<tArgs>...>::kValue[missing(
+            toCanonicalList<ClosedSet>())];
+    this->clearLog();
+    fill(*this, aArgs...);
+    return view<tEvaluables...>(QueryList{});
+  }
+
+  // Drops all cached results.
+  void invalidate() { mCache = Cache(); }
+
+  // Tells the version of the input that the next evals are given. Drops the
+  // cached results if they were computed from another version.
+  void setVersion(std::size_t aVersion) {
+    if (aVersion != mVersion) {
+      invalidate();
+      mVersion = aVersion;
+    }
+  }
+
+private:
+  Cache mCache;
+  std::size_t mVersion = 0;
+};
+
+// An Evaluator over an input that grows, such as a time series, where each
+// functor declares a State that keeps what it has seen so far:
+//
+//   struct State {
+//     void update(tArgs... aNewElements);
+//     std::tuple<...> finalize(tInputs... aInputs) const;
+//   };
+//
+// finalize returns the evaluables of EvalList, given the inputs of InputList,
+// and may take FromResource first, like functors do (see WithMemoryResource).
+// A Stream of a query keeps the states of the functors that cover it only, so
+// that appending costs what updating these states does, and evaluating what
+// finalizing them does.
+template <typename tUniverse, typename tPolicy, typename... tFunctors>
+class StreamingEvaluator : public Evaluator<tUniverse, tPolicy, tFunctors...> {
+  using Base = Evaluator<tUniverse, tPolicy, tFunctors...>;
+
+  static_assert((evaluator_impl::HasState<tFunctors>::value && ...),
+                "Functors of a StreamingEvaluator must declare a State.");
+
+  template <typename tState, typename tBufferList, typename tBuffer,
+            std::size_t... tInputs>
+  static auto finalize(Base &aSelf, const tState &aState,
+                       const tBuffer &aBuffer,
+                       std::index_sequence<tInputs...>) {
+    auto finalizeState = [&aState](const auto &...aParams)
+        -> decltype(aState.finalize(aParams...)) {
+      return aState.finalize(aParams...);
+    };
+    return Base::invoke(
+        aSelf, finalizeState,
+        *std::get<tuple_util_impl::positionOf<tInputs>(tBufferList{})>(
+            aBuffer)...);
+  }
+
+  // Finalizes the state of the tI-th functor of the cover into aBuffer.
+  struct FinalizeStep {
+    template <size_t tI, typename tPlan, typename tBufferList,
+              typename tBuffer, typename tStates>
+    static void run(Base &aSelf, tBuffer &aBuffer, const tStates &aStates) {
+      using IthFunctor = typename Base::FunctorByCandidate::template Find<
+          std::tuple_element_t<tI, typename tPlan::Cover>>;
+      using InputList = typename Base::template InputList<IthFunctor>;
+      auto src = static_cast<StreamingEvaluator &>(aSelf)
+                     .template measure<IthFunctor, tPlan, tI>([&] {
+                       return finalize<typename IthFunctor::State,
+                                       tBufferList>(aSelf,
+                                                    std::get<tI>(aStates),
+                                                    aBuffer, InputList{});
+                     });
+      scatter(aBuffer, std::move(src),
+              std::make_index_sequence<std::tuple_size_v<decltype(src)>>{},
+              typename IthFunctor::EvalList{},
+              typename tPlan::template OwnedList<tI, tBufferList>{});
+    }
+  };
+
+  template <typename... tCandidates>
+  static auto statesOf(std::tuple<tCandidates...> *) -> std::tuple<
+      typename Base::FunctorByCandidate::template Find<tCandidates>::State...>;
+
+public:
+  using Base::Base;
+
+  // The states of the functors that cover tEvaluables, which start empty.
+  template <typename... tEvaluables> class Stream {
+    using MyPlan = typename Base::template Plan<
+        typename tUniverse::template Set<tEvaluables...>>;
+    using States = decltype(statesOf(
+        static_cast<typename MyPlan::Cover *>(nullptr)));
+
+  public:
+    explicit Stream(StreamingEvaluator &aEvaluator) : mEvaluator(aEvaluator) {}
+
+    // Updates each state with aNewElements, with the execution policy of the
+    // evaluator.
+    template <typename... tArgs> void update(const tArgs &...aNewElements) {
+      std::apply(
+          [&](auto &...aStates) {
+            mEvaluator.execution().run(
+                [&aStates, &aNewElements...] {
+                  aStates.update(aNewElements...);
+                }...);
+          },
+          mStates);
+    }
+
+    // Like Evaluator::eval, over all elements so far.
+    std::tuple<typename tEvaluables::Type...> eval() {
+      using BufferList =
+          typename Base::template BufferListOf<tEvaluables...>;
+      mEvaluator.clearLog();
+      decltype(Base::makeBuffer(BufferList{})) buffer;
+      mEvaluator.template sparseEval<MyPlan, BufferList, FinalizeStep>(
+          buffer, mStates);
+      return Base::template unwrap<tEvaluables...>(
+          buffer, std::index_sequence_for<tEvaluables...>{});
+    }
+
+    // Forgets all elements so far.
+    void reset() { mStates = States(); }
+
+  private:
+    StreamingEvaluator &mEvaluator;
+    States mStates;
+  };
+
+  template <typename... tEvaluables> Stream<tEvaluables...> stream() {
+    return Stream<tEvaluables...>(*this);
   }
 };
 
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace set_cover {
+
+// An execution policy runs a batch of independent tasks, and returns once all
+// of them are done:
+//
+//   template <typename... tTasks> void run(tTasks &&...aTasks);
+//
+// Tasks may run concurrently, but never concurrently with the caller after
+// run returns. If tasks throw, run rethrows one of their exceptions.
+
+// Runs tasks one after another on the calling thread.
+struct Sequential {
+  template <typename... tTasks> void run(tTasks &&...aTasks) {
+    (std::forward<tTasks>(aTasks)(), ...);
+  }
+};
+
+// Runs tasks on a fixed set of worker threads, and the last task of each batch
+// on the calling thread, which then helps with queued tasks until the batch is
+// done. A batch of one task never leaves the calling thread, so that small
+// batches cost no more than with Sequential.
+class ThreadPool {
+public:
+  // One worker per hardware thread besides the caller's.
+  ThreadPool()
+      : ThreadPool(std::max(1u, std::thread::hardware_concurrency()) - 1) {}
+
+  explicit ThreadPool(std::size_t aWorkerCount) {
+    for (std::size_t i = 0; i < aWorkerCount; ++i) {
+      mWorkers.emplace_back([this] { work(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopping = true;
+    }
+    mWake.notify_all();
+    for (std::thread &worker : mWorkers) {
+      worker.join();
+    }
+  }
+
+  std::size_t workerCount() const { return mWorkers.size(); }
+
+  template <typename... tTasks> void run(tTasks &&...aTasks) {
+    if constexpr (sizeof...(tTasks) > 1) {
+      if (!mWorkers.empty()) {
+        Batch batch;
+        batch.mPending = sizeof...(tTasks);
+        runBatch(batch, aTasks...);
+        return;
+      }
+    }
+    Sequential().run(std::forward<tTasks>(aTasks)...);
+  }
+
+private:
+  struct Batch {
+    std::size_t mPending = 0;
+    std::exception_ptr mError;
+  };
+
+  // A queued task, which lives on the stack of the runBatch that queued it.
+  // runBatch does not return before the batch is done, so that queuing a task
+  // allocates nothing.
+  struct Task {
+    void (*mRun)(ThreadPool &, Task &);
+    Batch *mBatch;
+  };
+
+  template <typename tTask> struct TaskOf : public Task {
+    tTask *mTask;
+  };
+
+  template <typename tTask> void runTask(Batch &aBatch, tTask &aTask) {
+    std::exception_ptr error;
+    try {
+      aTask();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (error && !aBatch.mError) {
+      aBatch.mError = error;
+    }
+    if (--aBatch.mPending == 0) {
+      mDone.notify_all();
+    }
+  }
+
+  template <typename tTask, typename... tTasks>
+  void runBatch(Batch &aBatch, tTask &aTask, tTasks &...aTasks) {
+    if constexpr (sizeof...(tTasks) == 0) {
+      runTask(aBatch, aTask);
+      finish(aBatch);
+    } else {
+      TaskOf<tTask> task;
+      task.mRun = [](ThreadPool &aPool, Task &aQueued) {
+        aPool.runTask(*aQueued.mBatch,
+                      *static_cast<TaskOf<tTask> &>(aQueued).mTask);
+      };
+      task.mBatch = &aBatch;
+      task.mTask = &aTask;
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQueue.push_back(&task);
+      }
+      mWake.notify_one();
+      runBatch(aBatch, aTasks...);
+    }
+  }
+
+  // Helps with queued tasks, which may belong to other batches, until aBatch
+  // is done.
+  void finish(Batch &aBatch) {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (aBatch.mPending != 0) {
+      if (mQueue.empty()) {
+        mDone.wait(lock, [&] { return aBatch.mPending == 0; });
+        continue;
+      }
+      Task &task = *mQueue.front();
+      mQueue.pop_front();
+      lock.unlock();
+      task.mRun(*this, task);
+      lock.lock();
+    }
+    if (aBatch.mError) {
+      std::rethrow_exception(aBatch.mError);
+    }
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+      mWake.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+      if (mQueue.empty()) {
+        return;
+      }
+      Task &task = *mQueue.front();
+      mQueue.pop_front();
+      lock.unlock();
+      task.mRun(*this, task);
+      lock.lock();
+    }
+  }
+
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::condition_variable mDone;
+  std::deque<Task *> mQueue;
+  bool mStopping = false;
+  std::vector<std::thread> mWorkers;
+};
+
+} // namespace set_cover
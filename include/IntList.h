@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SET_COVER_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define SET_COVER_X86_KERNELS 0
+#endif
+
+#include "Evaluator.h"
+
+// The IntList of the README: properties of a list of integers, computed by
+// functors that share passes over the list, with kernels that use the widest
+// vector instructions that the CPU has.
+namespace set_cover {
+namespace int_list {
+
+// Instruction sets that the kernels are written for, narrowest first.
+enum class Isa { Scalar, Sse41, Avx2 };
+
+inline bool isSupported(Isa aIsa) {
+#if SET_COVER_X86_KERNELS
+  switch (aIsa) {
+  case Isa::Avx2:
+    return __builtin_cpu_supports("avx2");
+  case Isa::Sse41:
+    return __builtin_cpu_supports("sse4.1");
+  default:
+    return true;
+  }
+#else
+  return aIsa == Isa::Scalar;
+#endif
+}
+
+// The widest instruction set that the CPU supports, found once.
+inline Isa bestIsa() {
+  static const Isa kBest = isSupported(Isa::Avx2)    ? Isa::Avx2
+                           : isSupported(Isa::Sse41) ? Isa::Sse41
+                                                     : Isa::Scalar;
+  return kBest;
+}
+
+// Sums of a list, shifted by its first element so that the variance does not
+// cancel out for lists far from zero.
+struct Moments {
+  double mShift = 0;
+  double mSum = 0;
+  double mSumOfSquares = 0;
+};
+
+namespace int_list_impl {
+
+inline std::pair<int, int> minMaxScalar(const int *aData, std::size_t aSize,
+                                        std::size_t aFrom,
+                                        std::pair<int, int> aMinMax) {
+  for (std::size_t i = aFrom; i < aSize; ++i) {
+    aMinMax.first = std::min(aMinMax.first, aData[i]);
+    aMinMax.second = std::max(aMinMax.second, aData[i]);
+  }
+  return aMinMax;
+}
+
+inline Moments momentsScalar(const int *aData, std::size_t aSize,
+                             std::size_t aFrom, Moments aMoments) {
+  for (std::size_t i = aFrom; i < aSize; ++i) {
+    const double shifted = aData[i] - aMoments.mShift;
+    aMoments.mSum += shifted;
+    aMoments.mSumOfSquares += shifted * shifted;
+  }
+  return aMoments;
+}
+
+#if SET_COVER_X86_KERNELS
+
+template <typename tLanes>
+std::pair<int, int> reduceMinMax(const tLanes &aMins, const tLanes &aMaxs) {
+  return {*std::min_element(std::begin(aMins), std::end(aMins)),
+          *std::max_element(std::begin(aMaxs), std::end(aMaxs))};
+}
+
+__attribute__((target("sse4.1"))) inline std::pair<int, int>
+minMaxSse41(const int *aData, std::size_t aSize) {
+  constexpr std::size_t kLanes = 4;
+  if (aSize < kLanes) {
+    return minMaxScalar(aData, aSize, 0, {aData[0], aData[0]});
+  }
+  __m128i mins = _mm_loadu_si128(reinterpret_cast<const __m128i *>(aData));
+  __m128i maxs = mins;
+  std::size_t i = kLanes;
+  for (; i + kLanes <= aSize; i += kLanes) {
+    const __m128i values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(aData + i));
+    mins = _mm_min_epi32(mins, values);
+    maxs = _mm_max_epi32(maxs, values);
+  }
+  int minLanes[kLanes];
+  int maxLanes[kLanes];
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(minLanes), mins);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(maxLanes), maxs);
+  return minMaxScalar(aData, aSize, i, reduceMinMax(minLanes, maxLanes));
+}
+
+__attribute__((target("avx2"))) inline std::pair<int, int>
+minMaxAvx2(const int *aData, std::size_t aSize) {
+  constexpr std::size_t kLanes = 8;
+  if (aSize < kLanes) {
+    return minMaxScalar(aData, aSize, 0, {aData[0], aData[0]});
+  }
+  __m256i mins = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(aData));
+  __m256i maxs = mins;
+  std::size_t i = kLanes;
+  for (; i + kLanes <= aSize; i += kLanes) {
+    const __m256i values =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(aData + i));
+    mins = _mm256_min_epi32(mins, values);
+    maxs = _mm256_max_epi32(maxs, values);
+  }
+  int minLanes[kLanes];
+  int maxLanes[kLanes];
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(minLanes), mins);
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(maxLanes), maxs);
+  return minMaxScalar(aData, aSize, i, reduceMinMax(minLanes, maxLanes));
+}
+
+// SSE2 is enough for these, but they are dispatched along with minMaxSse41.
+inline Moments momentsSse41(const int *aData, std::size_t aSize) {
+  constexpr std::size_t kLanes = 4;
+  Moments moments{static_cast<double>(aData[0])};
+  const __m128d shift = _mm_set1_pd(moments.mShift);
+  __m128d sums[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+  __m128d squares[2] = {_mm_setzero_pd(), _mm_setzero_pd()};
+  std::size_t i = 0;
+  for (; i + kLanes <= aSize; i += kLanes) {
+    const __m128i values =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(aData + i));
+    const __m128d halves[2] = {
+        _mm_sub_pd(_mm_cvtepi32_pd(values), shift),
+        _mm_sub_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(values, 0xEE)), shift)};
+    for (int h = 0; h < 2; ++h) {
+      sums[h] = _mm_add_pd(sums[h], halves[h]);
+      squares[h] = _mm_add_pd(squares[h], _mm_mul_pd(halves[h], halves[h]));
+    }
+  }
+  double sumLanes[2];
+  double squareLanes[2];
+  _mm_storeu_pd(sumLanes, _mm_add_pd(sums[0], sums[1]));
+  _mm_storeu_pd(squareLanes, _mm_add_pd(squares[0], squares[1]));
+  moments.mSum = sumLanes[0] + sumLanes[1];
+  moments.mSumOfSquares = squareLanes[0] + squareLanes[1];
+  return momentsScalar(aData, aSize, i, moments);
+}
+
+__attribute__((target("avx2"))) inline Moments
+momentsAvx2(const int *aData, std::size_t aSize) {
+  constexpr std::size_t kLanes = 8;
+  Moments moments{static_cast<double>(aData[0])};
+  const __m256d shift = _mm256_set1_pd(moments.mShift);
+  __m256d sums[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+  __m256d squares[2] = {_mm256_setzero_pd(), _mm256_setzero_pd()};
+  std::size_t i = 0;
+  for (; i + kLanes <= aSize; i += kLanes) {
+    const __m256i values =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(aData + i));
+    const __m256d halves[2] = {
+        _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(values)),
+                      shift),
+        _mm256_sub_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(values, 1)),
+                      shift)};
+    for (int h = 0; h < 2; ++h) {
+      sums[h] = _mm256_add_pd(sums[h], halves[h]);
+      squares[h] =
+          _mm256_add_pd(squares[h], _mm256_mul_pd(halves[h], halves[h]));
+    }
+  }
+  double sumLanes[4];
+  double squareLanes[4];
+  _mm256_storeu_pd(sumLanes, _mm256_add_pd(sums[0], sums[1]));
+  _mm256_storeu_pd(squareLanes, _mm256_add_pd(squares[0], squares[1]));
+  moments.mSum = (sumLanes[0] + sumLanes[1]) + (sumLanes[2] + sumLanes[3]);
+  moments.mSumOfSquares =
+      (squareLanes[0] + squareLanes[1]) + (squareLanes[2] + squareLanes[3]);
+  return momentsScalar(aData, aSize, i, moments);
+}
+
+#endif
+
+} // namespace int_list_impl
+
+// The smallest and the largest of aSize > 0 integers, in one pass.
+inline std::pair<int, int> minMax(const int *aData, std::size_t aSize,
+                                  Isa aIsa = bestIsa()) {
+#if SET_COVER_X86_KERNELS
+  switch (aIsa) {
+  case Isa::Avx2:
+    return int_list_impl::minMaxAvx2(aData, aSize);
+  case Isa::Sse41:
+    return int_list_impl::minMaxSse41(aData, aSize);
+  default:
+    break;
+  }
+#endif
+  return int_list_impl::minMaxScalar(aData, aSize, 0, {aData[0], aData[0]});
+}
+
+// The sum and the sum of squares of aSize > 0 integers, in one pass.
+inline Moments moments(const int *aData, std::size_t aSize,
+                       Isa aIsa = bestIsa()) {
+#if SET_COVER_X86_KERNELS
+  switch (aIsa) {
+  case Isa::Avx2:
+    return int_list_impl::momentsAvx2(aData, aSize);
+  case Isa::Sse41:
+    return int_list_impl::momentsSse41(aData, aSize);
+  default:
+    break;
+  }
+#endif
+  return int_list_impl::momentsScalar(aData, aSize, 0,
+                                      {static_cast<double>(aData[0])});
+}
+
+// The average and the population variance of aSize integers.
+inline std::pair<float, float> averageAndVariance(const Moments &aMoments,
+                                                  std::size_t aSize) {
+  const double shiftedAverage = aMoments.mSum / aSize;
+  return {static_cast<float>(aMoments.mShift + shiftedAverage),
+          static_cast<float>(aMoments.mSumOfSquares / aSize -
+                             shiftedAverage * shiftedAverage)};
+}
+
+struct Min {
+  static constexpr char name[] = "min";
+  using Type = int;
+};
+struct Max {
+  static constexpr char name[] = "max";
+  using Type = int;
+};
+struct Avg {
+  static constexpr char name[] = "avg";
+  using Type = float;
+};
+struct Var {
+  static constexpr char name[] = "var";
+  using Type = float;
+};
+// The element at the middle of the sorted list, the upper one of the two for
+// lists of even size.
+struct Median {
+  static constexpr char name[] = "median";
+  using Type = int;
+};
+struct Sorted {
+  static constexpr char name[] = "sorted";
+  using Type = std::vector<int>;
+};
+
+using U = Universe<Min, Max, Avg, Var, Median, Sorted>;
+
+// The functors below take a list that must not be empty. Those that scan it
+// use the kernels for mIsa, which is the best one unless they are given
+// another, e.g. to compare kernels.
+
+struct GetMinMax {
+  static constexpr char name[] = "GetMinMax";
+  using EvalList = U::KPerm<Min, Max>;
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+
+  explicit GetMinMax(Isa aIsa = bestIsa()) : mIsa(aIsa) {}
+
+  std::tuple<int, int> operator()(const std::vector<int> &aIn) const {
+    return minMax(aIn.data(), aIn.size(), mIsa);
+  }
+
+  Isa mIsa;
+};
+
+struct GetAvgVar {
+  static constexpr char name[] = "GetAvgVar";
+  using EvalList = U::KPerm<Avg, Var>;
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+
+  explicit GetAvgVar(Isa aIsa = bestIsa()) : mIsa(aIsa) {}
+
+  std::tuple<float, float> operator()(const std::vector<int> &aIn) const {
+    return averageAndVariance(moments(aIn.data(), aIn.size(), mIsa),
+                              aIn.size());
+  }
+
+  Isa mIsa;
+};
+
+// Partitions a copy of the list around its middle, which takes linear time
+// on average. The copy is kept across calls.
+struct GetMedian {
+  static constexpr char name[] = "GetMedian";
+  using EvalList = U::KPerm<Median>;
+  static constexpr std::size_t cost(std::size_t aSize) { return 2 * aSize; }
+
+  std::tuple<int> operator()(const std::vector<int> &aIn) {
+    mScratch.assign(aIn.begin(), aIn.end());
+    const auto middle = mScratch.begin() + mScratch.size() / 2;
+    std::nth_element(mScratch.begin(), middle, mScratch.end());
+    return *middle;
+  }
+
+  std::vector<int> mScratch;
+};
+
+// Sorts into the storage of the result, see Evaluator::evalInto.
+struct GetSorted {
+  static constexpr char name[] = "GetSorted";
+  using EvalList = U::KPerm<Sorted, Min, Max, Median>;
+  static constexpr std::size_t cost(std::size_t aSize) {
+    std::size_t log2 = 1;
+    for (std::size_t size = aSize; size > 1; size /= 2) {
+      ++log2;
+    }
+    return aSize * log2;
+  }
+
+  void operator()(InPlace, std::vector<int> &aSorted, int &aMin, int &aMax,
+                  int &aMedian, const std::vector<int> &aIn) const {
+    aSorted.assign(aIn.begin(), aIn.end());
+    std::sort(aSorted.begin(), aSorted.end());
+    aMin = aSorted.front();
+    aMax = aSorted.back();
+    aMedian = aSorted[aSorted.size() / 2];
+  }
+};
+
+// Covers are weighted by the costs of the functors for lists of this size.
+constexpr std::size_t kSizeHint = 1 << 16;
+
+template <typename tPolicy = LogNothing>
+using IntListEvaluator = Evaluator<
+    U, WithMinSetCover<MinSetCover<WeightedExact<kSizeHint>>, tPolicy>,
+    GetMinMax, GetAvgVar, GetMedian, GetSorted>;
+
+// A list of integers, whose properties are computed together:
+//
+//   IntList list({3, 1, 2});
+//   const auto [min, max, median] = list.get<Min, Max, Median>();
+//
+// calls GetMinMax and GetMedian once each. The functors keep their scratch
+// buffers across gets, so that a list must not be read from two threads at
+// once. Lists must not be empty, as none of the properties is defined then;
+// the constructor throws std::invalid_argument otherwise.
+class IntList {
+public:
+  explicit IntList(std::vector<int> aData) : mData(std::move(aData)) {
+    if (mData.empty()) {
+      throw std::invalid_argument("IntList must not be empty.");
+    }
+  }
+
+  const std::vector<int> &data() const { return mData; }
+
+  template <typename... tProperties> auto get() {
+    return mEvaluator.template eval<tProperties...>(mData);
+  }
+
+  // Like get, into aOutputs, whose storage is reused (see evalInto).
+  template <typename... tProperties>
+  void getInto(typename tProperties::Type &...aOutputs) {
+    mEvaluator.template evalInto<tProperties...>(aOutputs..., mData);
+  }
+
+private:
+  std::vector<int> mData;
+  IntListEvaluator<> mEvaluator;
+};
+
+} // namespace int_list
+} // namespace set_cover
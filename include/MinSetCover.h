@@ -1,6 +1,8 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <limits>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -9,11 +11,69 @@
 
 namespace set_cover {
 
+namespace min_set_cover_impl {
+
+template <typename tCandidate, typename = void>
+struct HasCostModel : std::false_type {};
+
+template <typename tCandidate>
+struct HasCostModel<tCandidate,
+                    std::void_t<decltype(tCandidate::cost(std::size_t{}))>>
+    : std::true_type {};
+
+template <typename tCandidate, typename = void>
+struct HasCostValue : std::false_type {};
+
+template <typename tCandidate>
+struct HasCostValue<tCandidate,
+                    std::void_t<decltype(std::size_t{tCandidate::cost})>>
+    : std::true_type {};
+
+} // namespace min_set_cover_impl
+
+// Cost of a candidate when the input has size aSize. A candidate declares its
+// cost either as a value (`static constexpr std::size_t cost = ...;`) or as a
+// cost model (`static constexpr std::size_t cost(std::size_t aSize)`). A
+// candidate that declares neither costs 1.
+template <typename tCandidate> constexpr std::size_t costOf(std::size_t aSize) {
+  if constexpr (min_set_cover_impl::HasCostModel<tCandidate>::value) {
+    return tCandidate::cost(aSize);
+  } else if constexpr (min_set_cover_impl::HasCostValue<tCandidate>::value) {
+    return tCandidate::cost;
+  } else {
+    return 1;
+  }
+}
+
+// A candidate set that costs whatever tCostModel declares.
+template <typename tSet, typename tCostModel> struct Costed : public tSet {
+  static constexpr std::size_t cost(std::size_t aSize) {
+    return costOf<tCostModel>(aSize);
+  }
+};
+
 class GreedyTag {};
 
+// Picks the candidate that covers the most of the remaining set.
 template <typename tTiePolicy> class Greedy : public GreedyTag {
 public:
   using TiePolicy = tTiePolicy;
+
+  template <typename tCandidate> static constexpr std::size_t cost() {
+    return 1;
+  }
+};
+
+// Picks the candidate with the lowest cost per newly covered element, where
+// candidate costs are evaluated for an input of size tSizeHint.
+template <typename tTiePolicy, std::size_t tSizeHint = 1>
+class WeightedGreedy : public GreedyTag {
+public:
+  using TiePolicy = tTiePolicy;
+
+  template <typename tCandidate> static constexpr std::size_t cost() {
+    return costOf<tCandidate>(tSizeHint);
+  }
 };
 
 class Left;
@@ -43,59 +103,363 @@ public:
 
 using Arbitrary = FirstOneWins;
 
+class ExactTag {};
+
+// Finds a cover with the fewest candidates.
+class Exact : public ExactTag {
+public:
+  template <typename tCandidate> static constexpr std::size_t cost() {
+    return 1;
+  }
+};
+
+// Finds a cover with the lowest total cost, where candidate costs are
+// evaluated for an input of size tSizeHint. Ties go to the cover with fewer
+// candidates.
+template <std::size_t tSizeHint = 1> class WeightedExact : public ExactTag {
+public:
+  template <typename tCandidate> static constexpr std::size_t cost() {
+    return costOf<tCandidate>(tSizeHint);
+  }
+};
+
+class ReverseDeleteTag {};
+
+// Runs tAlgorithm, then walks its picks from the last to the first and drops
+// every pick whose share of the set is covered by the picks still kept.
+template <typename tAlgorithm> class ReverseDelete : public ReverseDeleteTag {
+public:
+  using Algorithm = tAlgorithm;
+};
+
 template <typename tAlgorithm, typename = void> class MinSetCover;
 
+namespace min_set_cover_impl {
+
+// Whether tLeft covers tSet at a strictly lower cost per element than tRight.
+// Compared by cross-multiplication to stay in integers.
+template <typename tAlgorithm, typename tSet, typename tLeft, typename tRight>
+constexpr bool isCheaper() {
+  return tAlgorithm::template cost<tLeft>() * commonality<tSet, tRight>() <
+         tAlgorithm::template cost<tRight>() * commonality<tSet, tLeft>();
+}
+
+template <std::size_t tN> struct Indices {
+  std::size_t count = 0;
+  std::size_t values[tN] = {};
+};
+
+// Indices of the candidates that cover tSet at the lowest cost per element,
+// computed over constexpr arrays so that a greedy step instantiates one
+// template rather than one per candidate.
+template <typename tAlgorithm, typename tSet, typename... tCandidates>
+struct Cheapest {
+  static constexpr std::size_t kN = sizeof...(tCandidates);
+  static constexpr std::size_t kW = maxWordCount<tSet, tCandidates...>();
+
+  static constexpr Indices<kN> kValue = [] {
+    const std::array<std::size_t, kW> set = words<kW, tSet>();
+    const std::array<std::size_t, kW> candidates[] = {
+        words<kW, tCandidates>()...};
+    const std::size_t costs[] = {tAlgorithm::template cost<tCandidates>()...};
+    std::size_t covers[kN] = {};
+    for (std::size_t i = 0; i < kN; ++i) {
+      for (std::size_t w = 0; w < kW; ++w) {
+        covers[i] += type_set_impl::popCount(set[w] & candidates[i][w]);
+      }
+    }
+    // Candidates that cover nothing are left out, as a cost of 0 would tie
+    // them with every other candidate. If no candidate covers anything, all
+    // of them tie, and picks() reports that the set is not covered.
+    std::size_t best = kN;
+    for (std::size_t i = 0; i < kN; ++i) {
+      if (covers[i] != 0 &&
+          (best == kN || costs[i] * covers[best] < costs[best] * covers[i])) {
+        best = i;
+      }
+    }
+    Indices<kN> tied;
+    for (std::size_t i = 0; i < kN; ++i) {
+      if (best == kN || (covers[i] != 0 && costs[i] * covers[best] ==
+                                               costs[best] * covers[i])) {
+        tied.values[tied.count++] = i;
+      }
+    }
+    return tied;
+  }();
+};
+
+// The candidates at the indices listed by tIndices::kValue.
+template <typename tIndices, typename... tCandidates, std::size_t... tIs>
+auto select(std::index_sequence<tIs...>)
+    -> std::tuple<ElementAt<tIndices::kValue.values[tIs], tCandidates...>...>;
+
+template <typename tIndices, typename... tCandidates>
+using Select = decltype(select<tIndices, tCandidates...>(
+    std::make_index_sequence<tIndices::kValue.count>{}));
+
+// Stands in for std::tuple while picks are collected, as building tuples
+// one element at a time is far slower to compile.
+template <typename... tCandidates> struct PickList {
+  using Tuple = std::tuple<tCandidates...>;
+};
+
+template <typename tCandidate, typename... tCandidates>
+auto prepend(PickList<tCandidates...>)
+    -> PickList<tCandidate, tCandidates...>;
+
+template <typename tAlgorithm, typename tSet, typename tCandidate>
+struct Contender {
+  using Candidate = tCandidate;
+};
+
+// The better of two contenders, where ties go to tAlgorithm::TiePolicy. A
+// contender that covers nothing of tSet never wins over one that does.
+// Folding this over the candidates finds the winner without recursing over
+// them.
+template <typename tAlgorithm, typename tSet, typename tLeft, typename tRight>
+constexpr auto operator|(Contender<tAlgorithm, tSet, tLeft>,
+                         Contender<tAlgorithm, tSet, tRight>) {
+  if constexpr (commonality<tSet, tLeft>() == 0 &&
+                commonality<tSet, tRight>() != 0) {
+    return Contender<tAlgorithm, tSet, tRight>{};
+  } else if constexpr (commonality<tSet, tRight>() == 0 &&
+                       commonality<tSet, tLeft>() != 0) {
+    return Contender<tAlgorithm, tSet, tLeft>{};
+  } else if constexpr (isCheaper<tAlgorithm, tSet, tLeft, tRight>()) {
+    return Contender<tAlgorithm, tSet, tLeft>{};
+  } else if constexpr (isCheaper<tAlgorithm, tSet, tRight, tLeft>()) {
+    return Contender<tAlgorithm, tSet, tRight>{};
+  } else if constexpr (std::is_same_v<typename tAlgorithm::TiePolicy::
+                                          template Pick<tLeft, tRight>,
+                                      Left>) {
+    return Contender<tAlgorithm, tSet, tLeft>{};
+  } else {
+    return Contender<tAlgorithm, tSet, tRight>{};
+  }
+}
+
+} // namespace min_set_cover_impl
+
 template <typename tAlgorithm>
 class MinSetCover<tAlgorithm,
                   std::enable_if_t<std::is_base_of_v<GreedyTag, tAlgorithm>>> {
 
-  template <std::size_t tI, typename tSet, typename... tCandidates>
-  static constexpr auto winner() {
-    static_assert(tI < sizeof...(tCandidates));
-    using CandidatesTuple = std::tuple<tCandidates...>;
-    using IthCandidate = std::tuple_element_t<tI, CandidatesTuple>;
-    if constexpr (tI == sizeof...(tCandidates) - 1) {
-      return IthCandidate{};
+  template <typename tSet, typename... tTied>
+  static auto winner(std::tuple<tTied...> *) ->
+      typename decltype((min_set_cover_impl::Contender<tAlgorithm, tSet,
+                                                       tTied>{} |
+                         ...))::Candidate;
+
+  template <typename tSet, typename... tCandidates>
+  using Winner = decltype(winner<tSet>(
+      static_cast<min_set_cover_impl::Select<
+          min_set_cover_impl::Cheapest<tAlgorithm, tSet, tCandidates...>,
+          tCandidates...> *>(nullptr)));
+
+  template <typename tSet, typename... tCandidates>
+  static constexpr auto picks() {
+    if constexpr (isEmpty<tSet>()) {
+      return min_set_cover_impl::PickList<>{};
     } else {
-      using CurrentWinner = decltype(winner<tI + 1, tSet, tCandidates...>());
-      if constexpr (commonality<tSet, IthCandidate>() ==
-                    commonality<tSet, CurrentWinner>()) {
-        if constexpr (std::is_same_v<
-                          typename tAlgorithm::TiePolicy::template Pick<
-                              IthCandidate, CurrentWinner>,
-                          Left>) {
-          return IthCandidate{};
-        } else {
-          return CurrentWinner{};
+      static_assert(sizeof...(tCandidates) != 0);
+      using MyWinner = Winner<tSet, tCandidates...>;
+      static_assert(commonality<tSet, MyWinner>() != 0,
+                    "Candidates do not cover the set.");
+      return min_set_cover_impl::prepend<MyWinner>(
+          picks<SetMinus<tSet, MyWinner>, tCandidates...>());
+    }
+  }
+
+public:
+  template <typename tSet, typename... tCandidates>
+  static constexpr auto eval() {
+    return typename decltype(picks<tSet, tCandidates...>())::Tuple{};
+  }
+};
+
+namespace min_set_cover_impl {
+
+template <std::size_t tW>
+constexpr bool isEmpty(const std::array<std::size_t, tW> &aWords) {
+  for (std::size_t i = 0; i < tW; ++i) {
+    if (aWords[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <std::size_t tW>
+constexpr std::array<std::size_t, tW>
+minus(std::array<std::size_t, tW> aWords,
+      const std::array<std::size_t, tW> &aOthers) {
+  for (std::size_t i = 0; i < tW; ++i) {
+    aWords[i] &= ~aOthers[i];
+  }
+  return aWords;
+}
+
+// Branch and bound over candidate subsets. Each branch picks one of the
+// candidates that cover the lowest uncovered element, so no subset is visited
+// twice, and branches that cannot beat the best cover found so far are cut.
+// Sets are tW words wide.
+template <std::size_t tN, std::size_t tW> class ExactSolver {
+public:
+  static_assert(tN <= std::numeric_limits<std::size_t>::digits);
+
+  using Words = std::array<std::size_t, tW>;
+
+  static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
+  constexpr ExactSolver(const Words (&aSets)[tN],
+                        const std::size_t (&aCosts)[tN]) {
+    for (std::size_t i = 0; i < tN; ++i) {
+      mSets[i] = aSets[i];
+      mCosts[i] = aCosts[i];
+    }
+  }
+
+  // Returns the picked candidates as a bitset over candidate indices, or
+  // kNone if aSet cannot be covered.
+  constexpr std::size_t solve(const Words &aSet) {
+    search(aSet, 0, 0, 0);
+    return mBestCost == kNone ? kNone : mBestPicks;
+  }
+
+private:
+  constexpr void search(const Words &aUncovered, std::size_t aPicks,
+                        std::size_t aCost, std::size_t aCount) {
+    if (aCost > mBestCost || (aCost == mBestCost && aCount >= mBestCount)) {
+      return;
+    }
+    if (isEmpty(aUncovered)) {
+      mBestPicks = aPicks;
+      mBestCost = aCost;
+      mBestCount = aCount;
+      return;
+    }
+    std::size_t w = 0;
+    while (aUncovered[w] == 0) {
+      ++w;
+    }
+    const std::size_t lowest = aUncovered[w] & (~aUncovered[w] + 1);
+    for (std::size_t i = 0; i < tN; ++i) {
+      if (mSets[i][w] & lowest) {
+        search(minus(aUncovered, mSets[i]), aPicks | (std::size_t{1} << i),
+               aCost + mCosts[i], aCount + 1);
+      }
+    }
+  }
+
+  Words mSets[tN] = {};
+  std::size_t mCosts[tN] = {};
+  std::size_t mBestPicks = 0;
+  std::size_t mBestCost = kNone;
+  std::size_t mBestCount = kNone;
+};
+
+// Lists the indices of the bits set in tBits.
+template <std::size_t tBits> struct BitIndices {
+  static constexpr Indices<std::numeric_limits<std::size_t>::digits> kValue =
+      [] {
+        Indices<std::numeric_limits<std::size_t>::digits> indices;
+        for (std::size_t i = 0; i < std::numeric_limits<std::size_t>::digits;
+             ++i) {
+          if ((tBits >> i) & 1) {
+            indices.values[indices.count++] = i;
+          }
         }
-      } else if constexpr (commonality<tSet, IthCandidate>() >
-                           commonality<tSet, CurrentWinner>()) {
-        return IthCandidate{};
-      } else {
-        return CurrentWinner{};
+        return indices;
+      }();
+};
+
+// Returns the picks to keep as a bitset over pick indices.
+template <std::size_t tN, std::size_t tW>
+constexpr std::size_t
+reverseDelete(const std::array<std::size_t, tW> &aSet,
+              const std::array<std::size_t, tW> (&aPicks)[tN]) {
+  static_assert(tN <= std::numeric_limits<std::size_t>::digits);
+  std::size_t kept = 0;
+  for (std::size_t i = 0; i < tN; ++i) {
+    kept |= std::size_t{1} << i;
+  }
+  for (std::size_t i = tN; i-- > 0;) {
+    std::array<std::size_t, tW> uncovered = aSet;
+    for (std::size_t j = 0; j < tN; ++j) {
+      if (j != i && ((kept >> j) & 1)) {
+        uncovered = minus(uncovered, aPicks[j]);
       }
     }
+    if (isEmpty(uncovered)) {
+      kept &= ~(std::size_t{1} << i);
+    }
   }
+  return kept;
+}
+
+} // namespace min_set_cover_impl
+
+template <typename tAlgorithm>
+class MinSetCover<tAlgorithm,
+                  std::enable_if_t<std::is_base_of_v<ExactTag, tAlgorithm>>> {
 
   template <typename tSet, typename... tCandidates>
-  static constexpr auto winner() {
-    static_assert(sizeof...(tCandidates) != 0);
-    return winner<0, tSet, tCandidates...>();
+  static constexpr std::size_t solve() {
+    constexpr std::size_t w = maxWordCount<tSet, tCandidates...>();
+    constexpr std::array<std::size_t, w> sets[] = {
+        words<w, tCandidates>()...};
+    constexpr std::size_t costs[] = {
+        tAlgorithm::template cost<tCandidates>()...};
+    return min_set_cover_impl::ExactSolver<sizeof...(tCandidates), w>(sets,
+                                                                       costs)
+        .solve(words<w, tSet>());
   }
 
 public:
+  // Picked candidates are returned in the order they were given.
   template <typename tSet, typename... tCandidates>
   static constexpr auto eval() {
-    if constexpr (tSet() == 0) {
+    if constexpr (isEmpty<tSet>()) {
+      return std::tuple<>{};
+    } else {
+      static_assert(sizeof...(tCandidates) != 0);
+      constexpr std::size_t picks = solve<tSet, tCandidates...>();
+      static_assert(picks != std::numeric_limits<std::size_t>::max(),
+                    "Candidates do not cover the set.");
+      return min_set_cover_impl::Select<
+          min_set_cover_impl::BitIndices<picks>, tCandidates...>{};
+    }
+  }
+};
+
+template <typename tAlgorithm>
+class MinSetCover<
+    tAlgorithm,
+    std::enable_if_t<std::is_base_of_v<ReverseDeleteTag, tAlgorithm>>> {
+
+  template <typename tSet, typename... tPicks>
+  static constexpr auto prune(std::tuple<tPicks...> *) {
+    if constexpr (sizeof...(tPicks) == 0) {
       return std::tuple<>{};
     } else {
-      using Winner = decltype(winner<tSet, tCandidates...>());
-      using RemainderSet =
-          std::integral_constant<std::size_t, tSet() & (~Winner())>;
-      return std::tuple_cat(std::tuple<Winner>{},
-                            eval<RemainderSet, tCandidates...>());
+      constexpr std::size_t w = maxWordCount<tSet, tPicks...>();
+      constexpr std::array<std::size_t, w> picks[] = {words<w, tPicks>()...};
+      constexpr std::size_t kept =
+          min_set_cover_impl::reverseDelete(words<w, tSet>(), picks);
+      return min_set_cover_impl::Select<min_set_cover_impl::BitIndices<kept>,
+                                        tPicks...>{};
     }
   }
+
+public:
+  // Kept picks are returned in the order tAlgorithm picked them.
+  template <typename tSet, typename... tCandidates>
+  static constexpr auto eval() {
+    using Picks = decltype(MinSetCover<typename tAlgorithm::Algorithm>::
+                               template eval<tSet, tCandidates...>());
+    return prune<tSet>(static_cast<Picks *>(nullptr));
+  }
 };
 
 } // namespace set_cover
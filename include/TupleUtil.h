@@ -19,4 +19,58 @@ constexpr auto reorder(const tTuple &aTuple, std::index_sequence<tIs...>) {
   return std::make_tuple(std::get<tIs>(aTuple)...);
 }
 
+namespace tuple_util_impl {
+
+// Position of tJ in tKs, or the number of tKs if absent.
+template <std::size_t tJ, std::size_t... tKs>
+constexpr std::size_t positionOf(std::index_sequence<tKs...>) {
+  std::size_t position = 0;
+  ((tKs == tJ ? false : (++position, true)) && ...);
+  return position;
+}
+
+template <std::size_t tPosition, typename tTgtTuple, typename tValue>
+constexpr void assignAt(tTgtTuple &aTgt, tValue &&aValue) {
+  if constexpr (tPosition < std::tuple_size_v<tTgtTuple>) {
+    std::get<tPosition>(aTgt) = std::forward<tValue>(aValue);
+  }
+}
+
+template <std::size_t tPosition, typename tTgtTuple, typename tValue>
+void pushBackAt(tTgtTuple &aTgt, tValue &&aValue) {
+  if constexpr (tPosition < std::tuple_size_v<tTgtTuple>) {
+    std::get<tPosition>(aTgt).push_back(std::forward<tValue>(aValue));
+  }
+}
+
+} // namespace tuple_util_impl
+
+// Like replace, but aTgt only holds the elements listed by tKs, so that
+// elements tJs of aSrc that are not among them are dropped. Elements are moved
+// out of aSrc when it is an rvalue.
+template <typename tTgtTuple, typename tSrcTuple, std::size_t... tIs,
+          std::size_t... tJs, std::size_t... tKs>
+constexpr void scatter(tTgtTuple &aTgt, tSrcTuple &&aSrc,
+                       std::index_sequence<tIs...>,
+                       std::index_sequence<tJs...>,
+                       std::index_sequence<tKs...>) {
+  (tuple_util_impl::assignAt<
+       tuple_util_impl::positionOf<tJs>(std::index_sequence<tKs...>{})>(
+       aTgt, std::get<tIs>(std::forward<tSrcTuple>(aSrc))),
+   ...);
+}
+
+// Like scatter, but aTgt holds containers, to the back of which the elements
+// are pushed.
+template <typename tTgtTuple, typename tSrcTuple, std::size_t... tIs,
+          std::size_t... tJs, std::size_t... tKs>
+void scatterBack(tTgtTuple &aTgt, tSrcTuple &&aSrc,
+                 std::index_sequence<tIs...>, std::index_sequence<tJs...>,
+                 std::index_sequence<tKs...>) {
+  (tuple_util_impl::pushBackAt<
+       tuple_util_impl::positionOf<tJs>(std::index_sequence<tKs...>{})>(
+       aTgt, std::get<tIs>(std::forward<tSrcTuple>(aSrc))),
+   ...);
+}
+
 } // namespace set_cover
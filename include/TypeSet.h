@@ -1,127 +1,293 @@
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <limits>
 #include <tuple>
 #include <type_traits>
 #include <utility>
 
-#include "BoolPack.h"
-#include "IndexSequenceUtil.h"
-
 namespace set_cover {
 
 namespace type_set_impl {
 
-template <std::size_t tI, typename... tElements> constexpr bool hasRepeats() {
-  if constexpr (sizeof...(tElements) == tI) {
-    return false;
-  } else {
-    using Ith = std::tuple_element<tI, std::tuple<tElements...>>;
-    using SameAsIth = BoolPack<std::is_same_v<Ith, tElements>...>;
-    using IsNotIth = decltype(unsetIndex<tI>(truePack<sizeof...(tElements)>()));
-    if constexpr (decltype(anyOf(andPack(SameAsIth{}, IsNotIth{}))){}) {
-      return true;
-    } else {
-      return hasRepeats<tI + 1, tElements...>();
-    }
-  }
+template <std::size_t tI, typename tElement> struct Indexed {};
+
+// Derives from Indexed<tI, tElement> for every element and its index, so that
+// the index of an element is found by overload resolution instead of by
+// recursing over the elements.
+template <typename tIndices, typename... tElements> struct IndexTable;
+
+template <std::size_t... tIs, typename... tElements>
+struct IndexTable<std::index_sequence<tIs...>, tElements...>
+    : public Indexed<tIs, tElements>... {};
+
+template <typename... tElements>
+using IndexTableOf =
+    IndexTable<std::index_sequence_for<tElements...>, tElements...>;
+
+constexpr std::size_t kNotFound = std::numeric_limits<std::size_t>::max();
+
+// Deducing tI fails both when tElement is absent and when it is repeated.
+template <typename tElement, std::size_t tI>
+constexpr std::size_t lookup(const Indexed<tI, tElement> *) {
+  return tI;
+}
+
+template <typename tElement> constexpr std::size_t lookup(const void *) {
+  return kNotFound;
 }
 
+template <std::size_t tI, typename tElement>
+auto elementAt(const Indexed<tI, tElement> *) -> tElement;
+
+template <typename tElement, typename... tElements>
+constexpr std::size_t kIndexOf =
+    lookup<tElement>(static_cast<const IndexTableOf<tElements...> *>(nullptr));
+
+template <typename... tElements>
+constexpr bool kHasRepeats = ((kIndexOf<tElements, tElements...> ==
+                               kNotFound) ||
+                              ... || false);
+
 } // namespace type_set_impl
 
+// The tI-th of tElements, found without recursing over them.
+template <std::size_t tI, typename... tElements>
+using ElementAt = decltype(type_set_impl::elementAt<tI>(
+    static_cast<const type_set_impl::IndexTableOf<tElements...> *>(nullptr)));
+
 template <typename... tElements> constexpr bool hasRepeats() {
-  return type_set_impl::hasRepeats<0, tElements...>();
+  return type_set_impl::kHasRepeats<tElements...>;
 };
 
-namespace type_set_impl {
+template <typename tElement, typename... tElements>
+constexpr std::size_t flagIndex() {
+  static_assert(hasRepeats<tElements...>() == false);
+  return type_set_impl::kIndexOf<tElement, tElements...>;
+}
 
-template <std::size_t tI, typename tElement, typename... tElements>
-constexpr std::size_t flag() {
-  if constexpr (sizeof...(tElements) == tI) {
-    return 0;
-  } else if (std::is_same_v<std::tuple_element_t<tI, std::tuple<tElements...>>,
-                            tElement>) {
-    return (flag<tI + 1, tElement, tElements...>() << 1) + 1;
+// Number of elements held by one word of a set.
+constexpr std::size_t kWordBits = std::numeric_limits<std::size_t>::digits;
+
+struct WideSetTag {};
+
+// A set that holds an element beyond the first word, as a bitset split into
+// words, least significant first. Sets that fit in one word are represented
+// as std::integral_constant<std::size_t, ...> instead, and the last word of a
+// WideSet is never zero, so that equal sets always have the same type.
+template <std::size_t... tWords> struct WideSet : public WideSetTag {
+  static_assert(sizeof...(tWords) > 1);
+  static constexpr std::size_t kWordCount = sizeof...(tWords);
+  static constexpr std::array<std::size_t, kWordCount> kWords = {tWords...};
+};
+
+template <typename tSet> constexpr std::size_t wordCount() {
+  if constexpr (std::is_base_of_v<WideSetTag, tSet>) {
+    return tSet::kWordCount;
   } else {
-    return flag<tI + 1, tElement, tElements...>() << 1;
+    return 1;
   }
 }
 
-} // namespace type_set_impl
+// The aI-th word of a set; zero past its last word.
+template <typename tSet> constexpr std::size_t word(std::size_t aI) {
+  if constexpr (std::is_base_of_v<WideSetTag, tSet>) {
+    return aI < tSet::kWordCount ? tSet::kWords[aI] : 0;
+  } else {
+    return aI == 0 ? std::size_t(tSet()) : 0;
+  }
+}
 
-template <typename tElement, typename... tElements>
-constexpr std::size_t flag() {
-  static_assert(hasRepeats<tElements...>() == false);
-  return type_set_impl::flag<0, tElement, tElements...>();
-};
+// The first tN words of a set.
+template <std::size_t tN, typename tSet>
+constexpr std::array<std::size_t, tN> words() {
+  std::array<std::size_t, tN> words = {};
+  for (std::size_t i = 0; i < tN; ++i) {
+    words[i] = word<tSet>(i);
+  }
+  return words;
+}
+
+template <typename... tSets> constexpr std::size_t maxWordCount() {
+  std::size_t count = 1;
+  ((count = wordCount<tSets>() > count ? wordCount<tSets>() : count), ...);
+  return count;
+}
 
 namespace type_set_impl {
 
-template <std::size_t tI, typename tElement, typename... tElements>
-constexpr std::size_t flagIndex() {
-  if constexpr (sizeof...(tElements) == tI) {
-    return std::numeric_limits<std::size_t>::max();
-  } else if (std::is_same_v<std::tuple_element_t<tI, std::tuple<tElements...>>,
-                            tElement>) {
-    return tI;
-  } else {
-    return flagIndex<tI + 1, tElement, tElements...>();
+constexpr std::size_t popCount(std::size_t aBits) {
+  std::size_t count = 0;
+  for (; aBits; aBits &= aBits - 1) {
+    ++count;
   }
+  return count;
 }
 
+template <typename tWords> constexpr std::size_t trimmedWordCount() {
+  std::size_t count = tWords::kValue.size();
+  while (count > 0 && tWords::kValue[count - 1] == 0) {
+    --count;
+  }
+  return count;
+}
+
+template <typename tWords, std::size_t... tIs>
+auto makeSet(std::index_sequence<tIs...>)
+    -> std::conditional_t<
+        (sizeof...(tIs) <= 1),
+        std::integral_constant<std::size_t, (0 | ... | tWords::kValue[tIs])>,
+        WideSet<tWords::kValue[tIs]...>>;
+
 } // namespace type_set_impl
 
-template <typename tElement, typename... tElements>
-constexpr std::size_t flagIndex() {
-  static_assert(hasRepeats<tElements...>() == false);
-  return type_set_impl::flagIndex<0, tElement, tElements...>();
+// The set whose words are tWords::kValue, in canonical representation.
+template <typename tWords>
+using MakeSet = decltype(type_set_impl::makeSet<tWords>(
+    std::make_index_sequence<type_set_impl::trimmedWordCount<tWords>()>{}));
+
+namespace type_set_impl {
+
+template <typename... tSets> struct UnionWords {
+  static constexpr std::size_t kCount = maxWordCount<tSets...>();
+  static constexpr auto kValue = [] {
+    std::array<std::size_t, kCount> words = {};
+    for (std::size_t i = 0; i < kCount; ++i) {
+      words[i] = (std::size_t{0} | ... | word<tSets>(i));
+    }
+    return words;
+  }();
+};
+
+template <typename tSet0, typename tSet1> struct IntersectionWords {
+  static constexpr std::size_t kCount = maxWordCount<tSet0, tSet1>();
+  static constexpr auto kValue = [] {
+    std::array<std::size_t, kCount> words = {};
+    for (std::size_t i = 0; i < kCount; ++i) {
+      words[i] = word<tSet0>(i) & word<tSet1>(i);
+    }
+    return words;
+  }();
+};
+
+template <typename tSet0, typename tSet1> struct MinusWords {
+  static constexpr std::size_t kCount = wordCount<tSet0>();
+  static constexpr auto kValue = [] {
+    std::array<std::size_t, kCount> words = {};
+    for (std::size_t i = 0; i < kCount; ++i) {
+      words[i] = word<tSet0>(i) & ~word<tSet1>(i);
+    }
+    return words;
+  }();
+};
+
+} // namespace type_set_impl
+
+// Union of any number of sets; the empty set for none.
+template <typename... tSets>
+using SetUnion = MakeSet<type_set_impl::UnionWords<tSets...>>;
+
+template <typename tSet0, typename tSet1>
+using SetIntersection =
+    MakeSet<type_set_impl::IntersectionWords<tSet0, tSet1>>;
+
+// Elements of tSet0 that are not in tSet1.
+template <typename tSet0, typename tSet1>
+using SetMinus = MakeSet<type_set_impl::MinusWords<tSet0, tSet1>>;
+
+template <typename tSet> constexpr bool isEmpty() {
+  for (std::size_t i = 0; i < wordCount<tSet>(); ++i) {
+    if (word<tSet>(i) != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename tSet> constexpr std::size_t size() {
-  std::size_t bits = tSet();
   std::size_t size = 0;
-  while (bits) {
-    size += bits & 1;
-    bits >>= 1;
+  for (std::size_t i = 0; i < wordCount<tSet>(); ++i) {
+    size += type_set_impl::popCount(word<tSet>(i));
   }
   return size;
 }
 
 template <typename tSet0, typename tSet1> constexpr std::size_t commonality() {
-  std::size_t intersection = tSet0() & tSet1();
   std::size_t commonality = 0;
-  while (intersection) {
-    commonality += intersection & 1;
-    intersection >>= 1;
+  for (std::size_t i = 0; i < maxWordCount<tSet0, tSet1>(); ++i) {
+    commonality += type_set_impl::popCount(word<tSet0>(i) & word<tSet1>(i));
   }
   return commonality;
 }
 
 template <typename tSet0, typename tSet1> constexpr std::size_t difference() {
-  std::size_t exclusiveOr = tSet0() ^ tSet1();
   std::size_t difference = 0;
-  while (exclusiveOr) {
-    difference += exclusiveOr & 1;
-    exclusiveOr >>= 1;
+  for (std::size_t i = 0; i < maxWordCount<tSet0, tSet1>(); ++i) {
+    difference += type_set_impl::popCount(word<tSet0>(i) ^ word<tSet1>(i));
   }
   return difference;
 }
 
 struct NotList;
 
+namespace type_set_impl {
+
+template <std::size_t... tFlagIndices> struct IndexWords {
+  static_assert(((tFlagIndices != kNotFound) && ...),
+                "Element is not in the universe.");
+
+  static constexpr std::size_t kCount = [] {
+    std::size_t count = 0;
+    ((count = tFlagIndices / kWordBits < count ? count
+                                               : tFlagIndices / kWordBits + 1),
+     ...);
+    return count;
+  }();
+  static constexpr auto kValue = [] {
+    std::array<std::size_t, kCount> words = {};
+    ((words[tFlagIndices / kWordBits] |= std::size_t{1}
+                                         << (tFlagIndices % kWordBits)),
+     ...);
+    return words;
+  }();
+};
+
+} // namespace type_set_impl
+
 template <std::size_t... tFlagIndices>
 constexpr auto toSet(std::index_sequence<tFlagIndices...>)
-    -> std::integral_constant<size_t, (... | (1 << tFlagIndices))>;
+    -> MakeSet<type_set_impl::IndexWords<tFlagIndices...>>;
+
+template <typename tElement, typename... tElements> constexpr auto flag() {
+  static_assert(hasRepeats<tElements...>() == false);
+  return decltype(toSet(
+      std::index_sequence<flagIndex<tElement, tElements...>()>{})){};
+};
+
+namespace type_set_impl {
+
+template <typename tSet, std::size_t... tIs>
+auto toCanonicalList(std::index_sequence<tIs...>) {
+  constexpr auto indices = [] {
+    std::array<std::size_t, sizeof...(tIs)> indices = {};
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < wordCount<tSet>() * kWordBits; ++i) {
+      if ((word<tSet>(i / kWordBits) >> (i % kWordBits)) & 1) {
+        indices[n++] = i;
+      }
+    }
+    return indices;
+  }();
+  return std::index_sequence<indices[tIs]...>();
+}
+
+} // namespace type_set_impl
 
+// Lists the elements of a set in the canonical order.
 template <typename tSet> constexpr auto toCanonicalList() {
-  if constexpr (tSet() == 0) {
-    return std::index_sequence<>();
-  } else if (tSet() & 1) {
-    return prepend<0>(add<1>(toCanonicalList<(tSet() >> 1)>()));
-  } else {
-    return add<1>(toCanonicalList<(tSet() >> 1)>());
-  }
+  return type_set_impl::toCanonicalList<tSet>(
+      std::make_index_sequence<size<tSet>()>{});
 }
 
 // Universe defines a canonical order over elements.
@@ -130,9 +296,8 @@ template <typename... tElements> struct Universe {
 
   // A set of elements is represented as bitset indexed in the canonical order.
   template <typename... tSetElements>
-  using Set =
-      std::integral_constant<std::size_t,
-                             (... | flag<tSetElements, tElements...>())>;
+  using Set = decltype(toSet(
+      std::index_sequence<flagIndex<tSetElements, tElements...>()...>{}));
 
   // A list of elements is represented as a sequence of flag indices.
   template <typename... tListElements>
@@ -0,0 +1,151 @@
+#include <AsyncEvaluator.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <typeindex>
+#include <vector>
+
+using namespace set_cover;
+
+struct Min {
+  using Type = int;
+};
+struct Max {
+  using Type = int;
+};
+struct Sum {
+  using Type = long;
+};
+struct Range {
+  using Type = int;
+};
+
+using U = Universe<Min, Max, Sum, Range>;
+
+// Suspends coroutines until it is opened, and then resumes them last first,
+// on the thread that opens it.
+class Gate {
+public:
+  auto wait() {
+    struct Waiter {
+      Gate &mGate;
+      bool await_ready() { return false; }
+      void await_suspend(std::coroutine_handle<> aWaiter) {
+        std::lock_guard<std::mutex> lock(mGate.mMutex);
+        mGate.mWaiters.push_back(aWaiter);
+      }
+      void await_resume() {}
+    };
+    return Waiter{*this};
+  }
+
+  std::size_t waiterCount() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWaiters.size();
+  }
+
+  void open() {
+    std::vector<std::coroutine_handle<>> waiters;
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      waiters.swap(mWaiters);
+    }
+    std::for_each(waiters.rbegin(), waiters.rend(),
+                  [](std::coroutine_handle<> aWaiter) { aWaiter.resume(); });
+  }
+
+private:
+  std::mutex mMutex;
+  std::vector<std::coroutine_handle<>> mWaiters;
+};
+
+// Reads its result once the gate opens, as if from disk.
+struct ReadMin {
+  using EvalList = U::KPerm<Min>;
+  Task<std::tuple<int>> operator()(const std::vector<int> &aIn) {
+    co_await mGate->wait();
+    co_return *std::min_element(aIn.begin(), aIn.end());
+  }
+  Gate *mGate = nullptr;
+};
+
+struct ReadMax {
+  using EvalList = U::KPerm<Max>;
+  Task<std::tuple<int>> operator()(const std::vector<int> &aIn) {
+    co_await mGate->wait();
+    co_return *std::max_element(aIn.begin(), aIn.end());
+  }
+  Gate *mGate = nullptr;
+};
+
+struct GetSum {
+  using EvalList = U::KPerm<Sum>;
+  std::tuple<long> operator()(const std::vector<int> &aIn) {
+    return std::accumulate(aIn.begin(), aIn.end(), 0l);
+  }
+};
+
+struct GetRange {
+  using EvalList = U::KPerm<Range>;
+  using InputList = U::KPerm<Min, Max>;
+  std::tuple<int> operator()(const std::vector<int> &, int aMin, int aMax) {
+    return aMax - aMin;
+  }
+};
+
+struct ReadNothing {
+  using EvalList = U::KPerm<Max>;
+  Task<std::tuple<int>> operator()(const std::vector<int> &) {
+    throw std::runtime_error("Cannot read.");
+    co_return 0;
+  }
+};
+
+using MyAsyncEvaluator =
+    AsyncEvaluator<U, LogTypeIndex, ReadMin, ReadMax, GetSum, GetRange>;
+
+TEST(AsyncEvaluatorTest, AwaitsConcurrently) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Gate gate;
+  MyAsyncEvaluator e(ReadMin{&gate}, ReadMax{&gate}, GetSum{},
+                     GetRange{});
+  std::tuple<int, long, int> result;
+  std::thread waiter([&] {
+    result = syncWait(e.evalAsync<Range, Sum, Min>(std::cref(vec)));
+  });
+  // Both reads start before either is done, and GetSum runs in the meantime.
+  while (gate.waiterCount() < 2) {
+    std::this_thread::yield();
+  }
+  gate.open();
+  waiter.join();
+  EXPECT_EQ(result, std::make_tuple(7, 25l, 1));
+  const LogTypeIndex::Log expectedLog = {
+      std::type_index(typeid(ReadMin)), std::type_index(typeid(ReadMax)),
+      std::type_index(typeid(GetSum)), std::type_index(typeid(GetRange))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+}
+
+TEST(AsyncEvaluatorTest, SynchronousFunctorsRunInline) {
+  AsyncEvaluator<U, LogNothing, GetSum> e;
+  const auto [sum] = syncWait(e.evalAsync<Sum>(std::vector{1, 2, 3}));
+  EXPECT_EQ(sum, 6);
+}
+
+TEST(AsyncEvaluatorTest, TimesSynchronousFunctors) {
+  AsyncEvaluator<U, LogTiming, GetSum> e;
+  syncWait(e.evalAsync<Sum>(std::vector{1, 2, 3}));
+  syncWait(e.evalAsync<Sum>(std::vector{4, 5}));
+  ASSERT_EQ(e.getLog().size(), 1);
+  EXPECT_EQ(e.getLog()[0].mCalls, 2);
+  EXPECT_EQ(e.getLog()[0].mBytes, 2 * sizeof(long));
+}
+
+TEST(AsyncEvaluatorTest, RethrowsFromAwaitables) {
+  AsyncEvaluator<U, LogNothing, ReadNothing, GetSum> e;
+  EXPECT_THROW(syncWait(e.evalAsync<Max, Sum>(std::vector{1, 2, 3})),
+               std::runtime_error);
+}
@@ -1,31 +1,42 @@
 #include <Evaluator.h>
 #include <algorithm>
 #include <gtest/gtest.h>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <sstream>
+#include <thread>
 #include <typeindex>
 #include <unordered_set>
 
 using namespace set_cover;
 
 struct Min {
+  static constexpr char name[] = "min";
   using Type = int;
 };
 struct Max {
+  static constexpr char name[] = "max";
   using Type = int;
 };
 struct Avg {
+  static constexpr char name[] = "avg";
   using Type = float;
 };
 struct Var {
+  static constexpr char name[] = "var";
   using Type = float;
 };
 struct Sorted {
+  static constexpr char name[] = "sorted";
   using Type = std::vector<int>;
 };
 
 using U = Universe<Min, Max, Avg, Var, Sorted>;
 
 struct GetMin {
+  static constexpr char name[] = "GetMin";
   using EvalList = U::KPerm<Min>;
   std::tuple<int> operator()(const std::vector<int> &aIn) {
     return *std::min_element(aIn.begin(), aIn.end());
@@ -33,6 +44,7 @@ struct GetMin {
 };
 
 struct GetMax {
+  static constexpr char name[] = "GetMax";
   using EvalList = U::KPerm<Max>;
   std::tuple<int> operator()(const std::vector<int> &aIn) {
     return *std::max_element(aIn.begin(), aIn.end());
@@ -40,6 +52,7 @@ struct GetMax {
 };
 
 struct GetSorted {
+  static constexpr char name[] = "GetSorted";
   using EvalList = U::KPerm<Sorted, Min, Max>;
   std::tuple<std::vector<int>, int, int>
   operator()(const std::vector<int> &aIn) {
@@ -50,6 +63,7 @@ struct GetSorted {
 };
 
 struct GetAvg {
+  static constexpr char name[] = "GetAvg";
   using EvalList = U::KPerm<Avg>;
   std::tuple<float> operator()(const std::vector<int> &aIn) {
     return std::accumulate(aIn.begin(), aIn.end(), 0.0) / aIn.size();
@@ -57,6 +71,7 @@ struct GetAvg {
 };
 
 struct GetVar {
+  static constexpr char name[] = "GetVar";
   using EvalList = U::KPerm<Var, Avg>;
   std::tuple<float, float> operator()(const std::vector<int> &aIn) {
     const auto [avg] = GetAvg()(aIn);
@@ -204,3 +219,1208 @@ TEST(EvaluatorTest, Case5InAlternateUniverse) {
   EXPECT_NEAR(var, 5.806, 1e-3);
   EXPECT_NEAR(avg, 4.167, 1e-3);
 }
+
+namespace {
+constexpr std::size_t log2(std::size_t aSize) {
+  std::size_t log = 0;
+  while (aSize >>= 1) {
+    ++log;
+  }
+  return log;
+}
+} // namespace
+
+// Same functors, but with declared costs.
+struct GetMinCosted : public GetMin {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+};
+
+struct GetMaxCosted : public GetMax {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+};
+
+struct GetSortedCosted : public GetSorted {
+  static constexpr std::size_t cost(std::size_t aSize) {
+    return aSize * (1 + log2(aSize));
+  }
+};
+
+struct GetAvgCosted : public GetAvg {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+};
+
+struct GetVarCosted : public GetVar {
+  static constexpr std::size_t cost(std::size_t aSize) {
+    return aSize + aSize / 2;
+  }
+};
+
+template <std::size_t tSizeHint>
+using CostedEvaluator = Evaluator<
+    U,
+    WithMinSetCover<MinSetCover<WeightedGreedy<TightestOneWins, tSizeHint>>,
+                    LogTypeIndex>,
+    GetMinCosted, GetMaxCosted, GetSortedCosted, GetAvgCosted, GetVarCosted>;
+
+TEST(EvaluatorTest, UncostedGreedyPrefersCoverage) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<U, LogTypeIndex, GetMinCosted, GetMaxCosted, GetSortedCosted,
+            GetAvgCosted, GetVarCosted>
+      e;
+  const auto [min, max] = e.eval<Min, Max>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetSortedCosted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+}
+
+TEST(EvaluatorTest, WeightedGreedyPrefersCheapScans) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CostedEvaluator<1 << 20> e;
+  const auto [min, max] = e.eval<Min, Max>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetMinCosted)),
+                           std::type_index(typeid(GetMaxCosted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+}
+
+// Greedy takes the cheap scans first, and only then the sort that also covers
+// what they did.
+TEST(EvaluatorTest, WeightedGreedyScansBeforeSorting) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CostedEvaluator<1 << 20> e;
+  const auto [min, max, sorted] = e.eval<Min, Max, Sorted>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetMinCosted)),
+                           std::type_index(typeid(GetMaxCosted)),
+                           std::type_index(typeid(GetSortedCosted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+}
+
+TEST(EvaluatorTest, WeightedGreedyPrefersFusedVarAvg) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CostedEvaluator<1 << 20> e;
+  const auto [var, avg] = e.eval<Var, Avg>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetVarCosted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+}
+
+using GreedyEvaluator =
+    Evaluator<U, WithMinSetCover<GreedyMinSetCover, LogTypeIndex>, GetMin,
+              GetMax, GetSorted, GetAvg, GetVar>;
+
+using ExactEvaluator =
+    Evaluator<U, WithMinSetCover<MinSetCover<Exact>, LogTypeIndex>, GetMin,
+              GetMax, GetSorted, GetAvg, GetVar>;
+
+namespace {
+template <typename tEvaluator, typename... tEvaluables>
+std::size_t countCalls(const std::vector<int> &aIn) {
+  tEvaluator e;
+  e.template eval<tEvaluables...>(aIn);
+  return e.getLog().size();
+}
+} // namespace
+
+// Computes min, max and avg in a single scan.
+struct GetMinMaxAvg {
+  using EvalList = U::KPerm<Min, Max, Avg>;
+  std::tuple<int, int, float> operator()(const std::vector<int> &aIn) {
+    const auto [min, max] = std::minmax_element(aIn.begin(), aIn.end());
+    return {*min, *max, std::get<0>(GetAvg()(aIn))};
+  }
+};
+
+using FusedGreedyEvaluator =
+    Evaluator<U, WithMinSetCover<GreedyMinSetCover, LogTypeIndex>,
+              GetMinMaxAvg, GetMin, GetMax, GetSorted, GetAvg, GetVar>;
+
+using FusedExactEvaluator =
+    Evaluator<U, WithMinSetCover<MinSetCover<Exact>, LogTypeIndex>,
+              GetMinMaxAvg, GetMin, GetMax, GetSorted, GetAvg, GetVar>;
+
+TEST(EvaluatorTest, ExactNeverCallsMoreThanGreedy) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  EXPECT_LE((countCalls<ExactEvaluator, Min>(vec)),
+            (countCalls<GreedyEvaluator, Min>(vec)));
+  EXPECT_LE((countCalls<ExactEvaluator, Max, Sorted>(vec)),
+            (countCalls<GreedyEvaluator, Max, Sorted>(vec)));
+  EXPECT_LE((countCalls<ExactEvaluator, Var, Avg>(vec)),
+            (countCalls<GreedyEvaluator, Var, Avg>(vec)));
+  EXPECT_LE((countCalls<ExactEvaluator, Min, Var, Avg>(vec)),
+            (countCalls<GreedyEvaluator, Min, Var, Avg>(vec)));
+  EXPECT_LE((countCalls<ExactEvaluator, Min, Max, Avg, Var>(vec)),
+            (countCalls<GreedyEvaluator, Min, Max, Avg, Var>(vec)));
+  EXPECT_LE((countCalls<FusedExactEvaluator, Min, Max, Avg>(vec)),
+            (countCalls<FusedGreedyEvaluator, Min, Max, Avg>(vec)));
+  // Greedy first picks GetMinMaxAvg, which GetSorted and GetVar make
+  // redundant.
+  EXPECT_LT(
+      (countCalls<FusedExactEvaluator, Min, Max, Avg, Var, Sorted>(vec)),
+      (countCalls<FusedGreedyEvaluator, Min, Max, Avg, Var, Sorted>(vec)));
+}
+
+TEST(EvaluatorTest, ExactCallsFewerThanGreedy) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  EXPECT_EQ(
+      (countCalls<FusedGreedyEvaluator, Min, Max, Avg, Var, Sorted>(vec)), 3);
+  EXPECT_EQ((countCalls<FusedExactEvaluator, Min, Max, Avg, Var, Sorted>(vec)),
+            2);
+
+  FusedExactEvaluator e;
+  const auto [min, max, avg, var, sorted] =
+      e.eval<Min, Max, Avg, Var, Sorted>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetSorted)),
+                           std::type_index(typeid(GetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+}
+
+// Greedy picks GetMinMaxAvg, then GetVar and GetSorted, which together cover
+// everything GetMinMaxAvg did.
+TEST(EvaluatorTest, ReverseDeleteDropsRedundantPick) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<U, LogTypeIndex, GetMinMaxAvg, GetMin, GetMax, GetSorted, GetAvg,
+            GetVar>
+      e;
+  const auto [min, max, avg, var, sorted] =
+      e.eval<Min, Max, Avg, Var, Sorted>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetSorted)),
+                           std::type_index(typeid(GetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+}
+
+TEST(EvaluatorTest, ReverseDeleteDropsScansCoveredBySort) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<U,
+            WithMinSetCover<MinSetCover<ReverseDelete<
+                                WeightedGreedy<TightestOneWins, 1 << 20>>>,
+                            LogTypeIndex>,
+            GetMinCosted, GetMaxCosted, GetSortedCosted, GetAvgCosted,
+            GetVarCosted>
+      e;
+  const auto [min, max, sorted] = e.eval<Min, Max, Sorted>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetSortedCosted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+}
+
+template <std::size_t tI> struct Property {
+  using Type = std::size_t;
+};
+
+namespace {
+template <std::size_t... tIs>
+auto makePropertyUniverse(std::index_sequence<tIs...>)
+    -> Universe<Property<tIs>...>;
+} // namespace
+
+// Wide enough to need three words per set.
+using WideU = decltype(makePropertyUniverse(std::make_index_sequence<150>{}));
+
+struct GetLow {
+  using EvalList = WideU::KPerm<Property<3>, Property<70>>;
+  std::tuple<std::size_t, std::size_t> operator()(std::size_t aIn) {
+    return {aIn + 3, aIn + 70};
+  }
+};
+
+struct GetHigh {
+  using EvalList = WideU::KPerm<Property<149>, Property<70>, Property<140>>;
+  std::tuple<std::size_t, std::size_t, std::size_t>
+  operator()(std::size_t aIn) {
+    return {aIn + 149, aIn + 70, aIn + 140};
+  }
+};
+
+struct GetHighest {
+  using EvalList = WideU::KPerm<Property<149>>;
+  std::tuple<std::size_t> operator()(std::size_t aIn) { return aIn + 149; }
+};
+
+TEST(EvaluatorTest, WideUniverse) {
+  Evaluator<WideU, LogTypeIndex, GetLow, GetHigh, GetHighest> e;
+  {
+    const auto [p149] = e.eval<Property<149>>(1000);
+    const Log expectedLog = {std::type_index(typeid(GetHighest))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(p149, 1149);
+  }
+  {
+    const auto [p140, p3, p149] =
+        e.eval<Property<140>, Property<3>, Property<149>>(1000);
+    const Log expectedLog = {std::type_index(typeid(GetLow)),
+                             std::type_index(typeid(GetHigh))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(p140, 1140);
+    EXPECT_EQ(p3, 1003);
+    EXPECT_EQ(p149, 1149);
+  }
+}
+
+// Counts default constructions, which only a result buffer does.
+struct Tracked {
+  static inline int sDefaultConstructed = 0;
+  Tracked() { ++sDefaultConstructed; }
+  explicit Tracked(int aValue) : mValue(aValue) {}
+  int mValue = 0;
+};
+
+struct Light {
+  using Type = int;
+};
+struct Heavy {
+  using Type = Tracked;
+};
+
+using TrackedU = Universe<Light, Heavy>;
+
+struct GetLightAndHeavy {
+  using EvalList = TrackedU::KPerm<Light, Heavy>;
+  std::tuple<int, Tracked> operator()(int aIn) { return {aIn, Tracked(aIn)}; }
+};
+
+TEST(EvaluatorTest, UnqueriedEvaluablesAreNotConstructed) {
+  Evaluator<TrackedU, LogNothing, GetLightAndHeavy> e;
+  Tracked::sDefaultConstructed = 0;
+  const auto [light] = e.eval<Light>(7);
+  EXPECT_EQ(light, 7);
+  EXPECT_EQ(Tracked::sDefaultConstructed, 0);
+  const auto [heavy] = e.eval<Heavy>(9);
+  EXPECT_EQ(heavy.mValue, 9);
+  EXPECT_EQ(Tracked::sDefaultConstructed, 0);
+}
+
+struct Counted {
+  static inline int sCopies = 0;
+  static inline int sMoveAssignments = 0;
+  explicit Counted(int aValue) : mValue(aValue) {}
+  Counted(const Counted &aOther) : mValue(aOther.mValue) { ++sCopies; }
+  Counted(Counted &&) = default;
+  Counted &operator=(const Counted &aOther) {
+    mValue = aOther.mValue;
+    ++sCopies;
+    return *this;
+  }
+  Counted &operator=(Counted &&aOther) {
+    mValue = aOther.mValue;
+    ++sMoveAssignments;
+    return *this;
+  }
+  int mValue;
+};
+
+struct Head {
+  using Type = int;
+};
+struct Shared {
+  using Type = Counted;
+};
+struct Tail {
+  using Type = std::unique_ptr<int>;
+};
+
+using MoveU = Universe<Head, Shared, Tail>;
+
+struct GetHeadShared {
+  using EvalList = MoveU::KPerm<Head, Shared>;
+  std::tuple<int, Counted> operator()(int aIn) {
+    return {aIn, Counted(aIn + 1)};
+  }
+};
+
+struct GetSharedTail {
+  using EvalList = MoveU::KPerm<Shared, Tail>;
+  std::tuple<Counted, std::unique_ptr<int>> operator()(int aIn) {
+    return {Counted(aIn + 1), std::make_unique<int>(aIn + 2)};
+  }
+};
+
+// Both functors return Shared, which must be moved into the result once, and
+// never copied.
+TEST(EvaluatorTest, ResultsAreMovedAndWrittenOnce) {
+  Evaluator<MoveU, LogTypeIndex, GetHeadShared, GetSharedTail> e;
+  Counted::sCopies = 0;
+  Counted::sMoveAssignments = 0;
+  const auto [tail, shared, head] = e.eval<Tail, Shared, Head>(10);
+  const Log expectedLog = {std::type_index(typeid(GetHeadShared)),
+                           std::type_index(typeid(GetSharedTail))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(*tail, 12);
+  EXPECT_EQ(shared.mValue, 11);
+  EXPECT_EQ(head, 10);
+  EXPECT_EQ(Counted::sCopies, 0);
+  EXPECT_EQ(Counted::sMoveAssignments, 0);
+}
+
+TEST(EvaluatorTest, ThreadPoolExecution) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  ThreadPool pool(2);
+  Evaluator<U, WithExecution<ThreadPool &, LogTypeIndex>, GetMin, GetMax,
+            GetSorted, GetAvg, GetVar>
+      e(pool);
+  for (int i = 0; i < 10; ++i) {
+    const auto [var, min, avg] = e.eval<Var, Min, Avg>(vec);
+    const Log expectedLog = {std::type_index(typeid(GetMin)),
+                             std::type_index(typeid(GetVar))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(min, 1);
+    EXPECT_NEAR(avg, 4.167, 1e-3);
+    EXPECT_NEAR(var, 5.806, 1e-3);
+  }
+}
+
+TEST(EvaluatorTest, EvaluatorsShareAThreadPool) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  ThreadPool pool(2);
+  using PooledPolicy = WithMemoryResource<std::pmr::monotonic_buffer_resource,
+                                          WithExecution<ThreadPool &>>;
+  Evaluator<U, PooledPolicy, GetMin, GetMax, GetSorted, GetAvg, GetVar> first(
+      pool);
+  Evaluator<U, WithExecution<ThreadPool &>, GetMin, GetMax, GetSorted,
+            GetAvg, GetVar>
+      second(pool, GetMin{}, GetMax{}, GetSorted{}, GetAvg{}, GetVar{});
+  EXPECT_EQ(&first.getExecution(), &pool);
+  EXPECT_EQ(&second.getExecution(), &pool);
+  const auto [min, var] = first.eval<Min, Var>(vec);
+  const auto [max, avg] = second.eval<Max, Avg>(vec);
+  EXPECT_EQ(min, 1);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  EXPECT_EQ(max, 8);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+}
+
+// A user-supplied executor, which sees each cover as one batch.
+struct CountingExecution {
+  template <typename... tTasks> void run(tTasks &&...aTasks) {
+    mBatchSizes.push_back(sizeof...(tTasks));
+    (aTasks(), ...);
+  }
+  std::vector<std::size_t> mBatchSizes;
+};
+
+TEST(EvaluatorTest, UserExecution) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<U, WithExecution<CountingExecution>, GetMin, GetMax, GetSorted,
+            GetAvg, GetVar>
+      e;
+  const auto [min, var] = e.eval<Min, Var>(vec);
+  const auto [sorted] = e.eval<Sorted>(vec);
+  EXPECT_EQ(min, 1);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+  EXPECT_EQ(e.getExecution().mBatchSizes, (std::vector<std::size_t>{2, 1}));
+}
+
+TEST(EvaluatorTest, EvalMaskOfEverySubset) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  MyEvaluator e;
+  for (std::size_t mask = 0; mask < 32; ++mask) {
+    const auto [min, max, avg, var, sorted] = e.evalMask(mask, vec);
+    ASSERT_EQ(min.has_value(), (mask & 1) != 0);
+    ASSERT_EQ(max.has_value(), (mask & 2) != 0);
+    ASSERT_EQ(avg.has_value(), (mask & 4) != 0);
+    ASSERT_EQ(var.has_value(), (mask & 8) != 0);
+    ASSERT_EQ(sorted.has_value(), (mask & 16) != 0);
+    EXPECT_EQ(min.value_or(1), 1);
+    EXPECT_EQ(max.value_or(8), 8);
+    EXPECT_NEAR(avg.value_or(4.167), 4.167, 1e-3);
+    EXPECT_NEAR(var.value_or(5.806), 5.806, 1e-3);
+    EXPECT_EQ(sorted.value_or(std::vector{1, 2, 3, 5, 6, 8}),
+              (std::vector{1, 2, 3, 5, 6, 8}));
+  }
+}
+
+TEST(EvaluatorTest, EvalMaskUsesTheCoverOfEval) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  MyEvaluator e;
+  const std::size_t mask = MyEvaluator::toMask(std::vector<std::size_t>{1, 0});
+  EXPECT_EQ(mask, (U::Set<Min, Max>{}));
+  EXPECT_EQ(MyEvaluator::coverOf(mask), 1 << 2);
+  e.evalMask(mask, vec);
+  const Log expectedLog = {std::type_index(typeid(GetSorted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(MyEvaluator::coverOf(MyEvaluator::toMask({0, 2, 3})),
+            (1 << 0) | (1 << 4));
+  EXPECT_THROW(MyEvaluator::toMask({5}), std::invalid_argument);
+  EXPECT_THROW(e.evalMask(32, vec), std::invalid_argument);
+}
+
+TEST(EvaluatorTest, EvalMaskOfDeclaredQueries) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  using Queries = std::tuple<U::Set<Sorted>, U::Set<Var, Min>, U::Set<Max>>;
+  MyEvaluator e;
+  {
+    const auto [min, max, avg, var, sorted] =
+        e.evalMask<Queries>(U::Set<Min, Var>{}, vec);
+    EXPECT_EQ(min, 1);
+    EXPECT_FALSE(max.has_value());
+    EXPECT_FALSE(avg.has_value());
+    EXPECT_NEAR(*var, 5.806, 1e-3);
+    EXPECT_FALSE(sorted.has_value());
+  }
+  {
+    const auto [min, max, avg, var, sorted] =
+        e.evalMask<Queries>(U::Set<Sorted>{}, vec);
+    EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+    EXPECT_FALSE(min.has_value());
+  }
+  EXPECT_EQ(MyEvaluator::coverOf<Queries>(U::Set<Max>{}), 1 << 1);
+  EXPECT_THROW(e.evalMask<Queries>(U::Set<Min>{}, vec), std::invalid_argument);
+}
+
+struct Median {
+  using Type = int;
+};
+struct Spread {
+  using Type = int;
+};
+
+using DepU = Universe<Min, Max, Avg, Var, Sorted, Median, Spread>;
+
+// Counts calls, to show that shared inputs are computed once per eval.
+template <typename tFunctor> struct CallCounted : public tFunctor {
+  static inline int sCalls = 0;
+  template <typename... tArgs>
+  auto operator()(const tArgs &...aArgs)
+      -> decltype(std::declval<tFunctor &>()(aArgs...)) {
+    ++sCalls;
+    return tFunctor::operator()(aArgs...);
+  }
+};
+
+struct DepGetSorted : public CallCounted<GetSorted> {
+  using EvalList = DepU::KPerm<Sorted, Min, Max>;
+};
+
+struct DepGetAvg : public CallCounted<GetAvg> {
+  using EvalList = DepU::KPerm<Avg>;
+};
+
+struct DepGetVar {
+  using EvalList = DepU::KPerm<Var>;
+  using InputList = DepU::KPerm<Avg>;
+  std::tuple<float> operator()(const std::vector<int> &aIn, float aAvg) {
+    float var = 0;
+    for (int val : aIn) {
+      var += (val - aAvg) * (val - aAvg);
+    }
+    return var / aIn.size();
+  }
+};
+
+struct DepGetMedian {
+  using EvalList = DepU::KPerm<Median>;
+  using InputList = DepU::KPerm<Sorted>;
+  std::tuple<int> operator()(const std::vector<int> &,
+                             const std::vector<int> &aSorted) {
+    return aSorted[aSorted.size() / 2];
+  }
+};
+
+// Reads two inputs, one of which has inputs of its own.
+struct DepGetSpread {
+  using EvalList = DepU::KPerm<Spread>;
+  using InputList = DepU::KPerm<Var, Median>;
+  std::tuple<int> operator()(const std::vector<int> &, float aVar,
+                             int aMedian) {
+    return aMedian + static_cast<int>(aVar);
+  }
+};
+
+template <typename tPolicy>
+using DepEvaluator = Evaluator<DepU, tPolicy, DepGetSorted, DepGetAvg,
+                               DepGetVar, DepGetMedian>;
+
+TEST(EvaluatorTest, InputsAreComputedFirst) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  DepEvaluator<LogTypeIndex> e;
+  DepGetAvg::sCalls = 0;
+  const auto [var, avg] = e.eval<Var, Avg>(vec);
+  const Log expectedLog = {std::type_index(typeid(DepGetAvg)),
+                           std::type_index(typeid(DepGetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(DepGetAvg::sCalls, 1);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+}
+
+TEST(EvaluatorTest, UnqueriedInputs) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  DepEvaluator<LogTypeIndex> e;
+  DepGetSorted::sCalls = 0;
+  const auto [median, min] = e.eval<Median, Min>(vec);
+  const Log expectedLog = {std::type_index(typeid(DepGetSorted)),
+                           std::type_index(typeid(DepGetMedian))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(DepGetSorted::sCalls, 1);
+  EXPECT_EQ(median, 5);
+  EXPECT_EQ(min, 1);
+}
+
+TEST(EvaluatorTest, InputsOfInputs) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  ThreadPool pool(2);
+  Evaluator<DepU, WithExecution<ThreadPool &, LogTypeIndex>, DepGetSorted,
+            DepGetAvg, DepGetVar, DepGetMedian, DepGetSpread>
+      e(pool);
+  DepGetAvg::sCalls = 0;
+  DepGetSorted::sCalls = 0;
+  const auto [spread] = e.eval<Spread>(vec);
+  EXPECT_EQ(spread, 5 + 5);
+  EXPECT_EQ(DepGetAvg::sCalls, 1);
+  EXPECT_EQ(DepGetSorted::sCalls, 1);
+}
+
+TEST(EvaluatorTest, EvalMaskWithInputs) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  DepEvaluator<LogTypeIndex> e;
+  const auto [min, max, avg, var, sorted, median, spread] =
+      e.evalMask(DepU::Set<Var>{}, vec);
+  EXPECT_NEAR(*var, 5.806, 1e-3);
+  EXPECT_FALSE(avg.has_value());
+  EXPECT_EQ(DepEvaluator<LogTypeIndex>::coverOf(DepU::Set<Var>{}),
+            (1 << 1) | (1 << 2));
+}
+
+using MyCachingEvaluator = CachingEvaluator<U, LogTypeIndex, GetMin, GetMax,
+                                            GetSorted, GetAvg, GetVar>;
+
+TEST(EvaluatorTest, CachingEvaluatorReusesResults) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  MyCachingEvaluator e;
+  {
+    const auto [min] = e.eval<Min>(vec);
+    const Log expectedLog = {std::type_index(typeid(GetMin))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(min, 1);
+  }
+  {
+    const auto [var, avg] = e.eval<Var, Avg>(vec);
+    const Log expectedLog = {std::type_index(typeid(GetVar))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_NEAR(var, 5.806, 1e-3);
+    EXPECT_NEAR(avg, 4.167, 1e-3);
+  }
+  {
+    const auto [avg, min] = e.eval<Avg, Min>(vec);
+    EXPECT_TRUE(e.getLog().empty());
+    EXPECT_NEAR(avg, 4.167, 1e-3);
+    EXPECT_EQ(min, 1);
+  }
+  {
+    const auto [max, sorted] = e.eval<Max, Sorted>(vec);
+    const Log expectedLog = {std::type_index(typeid(GetSorted))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(max, 8);
+    EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+  }
+}
+
+// Only the evaluables that are not cached are covered, so that GetVar alone
+// does once Sorted, Min and Max are known.
+TEST(EvaluatorTest, CachingEvaluatorCoversTheRemainder) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  MyCachingEvaluator e;
+  e.eval<Sorted, Min, Max>(vec);
+  const auto [min, max, avg, var] = e.eval<Min, Max, Avg, Var>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_NEAR(avg, 4.167, 1e-3);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+}
+
+TEST(EvaluatorTest, CachingEvaluatorInvalidation) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  const std::vector other = {4, 9, 7};
+  MyCachingEvaluator e;
+  e.setVersion(1);
+  EXPECT_EQ(std::get<0>(e.eval<Min>(vec)), 1);
+  e.setVersion(1);
+  EXPECT_EQ(std::get<0>(e.eval<Min>(other)), 1);
+  EXPECT_TRUE(e.getLog().empty());
+  e.setVersion(2);
+  EXPECT_EQ(std::get<0>(e.eval<Min>(other)), 4);
+  const Log expectedLog = {std::type_index(typeid(GetMin))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  e.invalidate();
+  EXPECT_EQ(std::get<0>(e.eval<Min>(vec)), 1);
+  EXPECT_EQ(e.getLog(), expectedLog);
+}
+
+// A functor that runs again for another query leaves the results that it
+// cached before in place.
+TEST(EvaluatorTest, CachingEvaluatorKeepsCachedResults) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CachingEvaluator<U, LogTypeIndex, GetSorted, GetAvg> e;
+  const auto [sorted] = e.eval<Sorted>(vec);
+  const int *data = sorted.data();
+  const auto [max] = e.eval<Max>(vec);
+  const Log expectedLog = {std::type_index(typeid(GetSorted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(max, 8);
+  EXPECT_EQ(&std::get<0>(e.eval<Sorted>(vec)), &sorted);
+  EXPECT_EQ(sorted.data(), data);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+}
+
+// Inputs are read from the cache rather than computed again.
+TEST(EvaluatorTest, CachingEvaluatorReusesInputs) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CachingEvaluator<DepU, LogTypeIndex, DepGetSorted, DepGetAvg, DepGetVar,
+                   DepGetMedian, DepGetSpread>
+      e;
+  DepGetAvg::sCalls = 0;
+  DepGetSorted::sCalls = 0;
+  e.eval<Avg>(vec);
+  e.eval<Sorted>(vec);
+  {
+    const auto [var] = e.eval<Var>(vec);
+    const Log expectedLog = {std::type_index(typeid(DepGetVar))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_NEAR(var, 5.806, 1e-3);
+  }
+  {
+    const auto [spread] = e.eval<Spread>(vec);
+    const Log expectedLog = {std::type_index(typeid(DepGetMedian)),
+                             std::type_index(typeid(DepGetSpread))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(spread, 5 + 5);
+  }
+  EXPECT_EQ(DepGetAvg::sCalls, 1);
+  EXPECT_EQ(DepGetSorted::sCalls, 1);
+}
+
+// Takes a whole batch, and counts the calls that do.
+struct GetMinOfBatch : public GetMin {
+  static inline int sBatchCalls = 0;
+  using GetMin::operator();
+  std::tuple<std::vector<int>>
+  operator()(InBatch, const std::vector<std::vector<int>> &aInputs) {
+    ++sBatchCalls;
+    std::vector<int> mins;
+    for (const std::vector<int> &input : aInputs) {
+      mins.push_back(*std::min_element(input.begin(), input.end()));
+    }
+    return mins;
+  }
+};
+
+TEST(EvaluatorTest, EvalBatch) {
+  const std::vector<std::vector<int>> inputs = {
+      {1, 5, 8, 2, 6, 3}, {4, 9, 7}, {2}};
+  Evaluator<U, LogTypeIndex, GetMinOfBatch, GetMax, GetSorted, GetAvg, GetVar>
+      e;
+  GetMinOfBatch::sBatchCalls = 0;
+  const auto [var, min, avg] = e.evalBatch<Var, Min, Avg>(inputs);
+  const Log expectedLog = {std::type_index(typeid(GetMinOfBatch)),
+                           std::type_index(typeid(GetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_EQ(GetMinOfBatch::sBatchCalls, 1);
+  EXPECT_EQ(min, (std::vector{1, 4, 2}));
+  ASSERT_EQ(avg.size(), 3);
+  EXPECT_NEAR(avg[0], 4.167, 1e-3);
+  EXPECT_NEAR(avg[1], 6.667, 1e-3);
+  EXPECT_NEAR(avg[2], 2, 1e-3);
+  ASSERT_EQ(var.size(), 3);
+  EXPECT_NEAR(var[0], 5.806, 1e-3);
+  EXPECT_NEAR(var[2], 0, 1e-3);
+
+  const auto [sorted] = e.evalBatch<Sorted>(std::vector<std::vector<int>>());
+  EXPECT_TRUE(sorted.empty());
+}
+
+// Takes the column of its input.
+struct DepGetVarOfBatch : public DepGetVar {
+  using DepGetVar::operator();
+  std::tuple<std::vector<float>>
+  operator()(InBatch, const std::vector<std::vector<int>> &aInputs,
+             const std::vector<float> &aAvgs) {
+    std::vector<float> vars;
+    for (std::size_t i = 0; i < aInputs.size(); ++i) {
+      vars.push_back(std::get<0>((*this)(aInputs[i], aAvgs[i])));
+    }
+    return vars;
+  }
+};
+
+TEST(EvaluatorTest, EvalBatchWithInputs) {
+  const std::vector<std::vector<int>> inputs = {{1, 5, 8, 2, 6, 3},
+                                                {4, 9, 7}};
+  ThreadPool pool(2);
+  Evaluator<DepU, WithExecution<ThreadPool &, LogTypeIndex>, DepGetSorted,
+            DepGetAvg, DepGetVarOfBatch, DepGetMedian, DepGetSpread>
+      e(pool);
+  DepGetAvg::sCalls = 0;
+  const auto [spread, avg] = e.evalBatch<Spread, Avg>(inputs);
+  EXPECT_EQ(spread, (std::vector{5 + 5, 7 + 4}));
+  ASSERT_EQ(avg.size(), 2);
+  EXPECT_NEAR(avg[1], 6.667, 1e-3);
+  EXPECT_EQ(DepGetAvg::sCalls, 2);
+}
+
+struct StreamMin {
+  using EvalList = U::KPerm<Min>;
+  struct State {
+    int mMin = std::numeric_limits<int>::max();
+    void update(const std::vector<int> &aNew) {
+      for (int val : aNew) {
+        mMin = std::min(mMin, val);
+      }
+    }
+    std::tuple<int> finalize() const { return mMin; }
+  };
+};
+
+// Counts its states, to show that only the states of a cover are kept.
+struct StreamMinMax {
+  using EvalList = U::KPerm<Min, Max>;
+  struct State {
+    static inline int sConstructed = 0;
+    State() { ++sConstructed; }
+    int mMin = std::numeric_limits<int>::max();
+    int mMax = std::numeric_limits<int>::min();
+    void update(const std::vector<int> &aNew) {
+      for (int val : aNew) {
+        mMin = std::min(mMin, val);
+        mMax = std::max(mMax, val);
+      }
+    }
+    std::tuple<int, int> finalize() const { return {mMin, mMax}; }
+  };
+};
+
+struct StreamAvg {
+  using EvalList = U::KPerm<Avg>;
+  struct State {
+    double mSum = 0;
+    std::size_t mCount = 0;
+    void update(const std::vector<int> &aNew) {
+      mSum = std::accumulate(aNew.begin(), aNew.end(), mSum);
+      mCount += aNew.size();
+    }
+    std::tuple<float> finalize() const { return mSum / mCount; }
+  };
+};
+
+// Welford's running mean and variance.
+struct StreamMoments {
+  using EvalList = U::KPerm<Avg, Var>;
+  struct State {
+    double mMean = 0;
+    double mM2 = 0;
+    std::size_t mCount = 0;
+    void update(const std::vector<int> &aNew) {
+      for (int val : aNew) {
+        ++mCount;
+        const double delta = val - mMean;
+        mMean += delta / mCount;
+        mM2 += delta * (val - mMean);
+      }
+    }
+    std::tuple<float, float> finalize() const {
+      return {mMean, mM2 / mCount};
+    }
+  };
+};
+
+// Takes the mean from another state.
+struct StreamVarOfAvg {
+  using EvalList = U::KPerm<Var>;
+  using InputList = U::KPerm<Avg>;
+  struct State {
+    double mSumOfSquares = 0;
+    std::size_t mCount = 0;
+    void update(const std::vector<int> &aNew) {
+      for (int val : aNew) {
+        mSumOfSquares += double(val) * val;
+      }
+      mCount += aNew.size();
+    }
+    std::tuple<float> finalize(float aAvg) const {
+      return mSumOfSquares / mCount - double(aAvg) * aAvg;
+    }
+  };
+};
+
+TEST(EvaluatorTest, StreamingEvaluator) {
+  StreamingEvaluator<U, LogTypeIndex, StreamMin, StreamMinMax, StreamAvg,
+                     StreamMoments>
+      e;
+  StreamMinMax::State::sConstructed = 0;
+  auto stream = e.stream<Min, Var>();
+  EXPECT_EQ(StreamMinMax::State::sConstructed, 0);
+  stream.update(std::vector{1, 5, 8});
+  stream.update(std::vector{2, 6, 3});
+  {
+    const auto [min, var] = stream.eval();
+    const Log expectedLog = {std::type_index(typeid(StreamMin)),
+                             std::type_index(typeid(StreamMoments))};
+    EXPECT_EQ(e.getLog(), expectedLog);
+    EXPECT_EQ(min, 1);
+    EXPECT_NEAR(var, 5.806, 1e-3);
+  }
+  stream.update(std::vector{0});
+  EXPECT_EQ(std::get<0>(stream.eval()), 0);
+  stream.reset();
+  stream.update(std::vector{4, 9});
+  EXPECT_EQ(std::get<0>(stream.eval()), 4);
+  EXPECT_NEAR(std::get<1>(stream.eval()), 6.25, 1e-3);
+
+  auto minMax = e.stream<Max, Min>();
+  minMax.update(std::vector{1, 5, 8, 2, 6, 3});
+  EXPECT_EQ(minMax.eval(), std::make_tuple(8, 1));
+  EXPECT_EQ(StreamMinMax::State::sConstructed, 1);
+
+  StreamingEvaluator<U, LogNothing, StreamMin, StreamAvg> passed(StreamMin{},
+                                                                 StreamAvg{});
+  auto avg = passed.stream<Avg>();
+  avg.update(std::vector{1, 5, 8, 2, 6, 3});
+  EXPECT_NEAR(std::get<0>(avg.eval()), 4.167, 1e-3);
+}
+
+TEST(EvaluatorTest, StreamingEvaluatorWithInputs) {
+  ThreadPool pool(2);
+  StreamingEvaluator<U, WithExecution<ThreadPool &, LogTypeIndex>, StreamMin,
+                     StreamAvg, StreamVarOfAvg>
+      e(pool);
+  auto stream = e.stream<Var>();
+  stream.update(std::vector{1, 5, 8});
+  stream.update(std::vector{2, 6, 3});
+  const auto [var] = stream.eval();
+  const Log expectedLog = {std::type_index(typeid(StreamAvg)),
+                           std::type_index(typeid(StreamVarOfAvg))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+}
+
+TEST(EvaluatorTest, LogTiming) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<U, LogTiming, GetMin, GetMax, GetSorted, GetAvg, GetVar> e;
+  e.eval<Min, Sorted>(vec);
+  e.eval<Max, Sorted>(vec);
+  e.evalBatch<Min>(std::vector{vec, vec, vec});
+  const LogTiming::Log &log = e.getLog();
+  ASSERT_EQ(log.size(), 5);
+  EXPECT_EQ(log[0].mCalls, 3);
+  EXPECT_EQ(log[0].mBytes, 3 * sizeof(int));
+  EXPECT_EQ(log[1].mCalls, 0);
+  EXPECT_EQ(log[2].mCalls, 2);
+  EXPECT_EQ(log[2].mBytes,
+            2 * (sizeof(std::vector<int>) + 6 * sizeof(int) + 2 * sizeof(int)));
+  for (const LogTiming::FunctorLog &functorLog : log) {
+    EXPECT_EQ(std::accumulate(functorLog.mBuckets.begin(),
+                              functorLog.mBuckets.end(), std::size_t{0}),
+              functorLog.mCalls);
+  }
+  EXPECT_LE(log[2].percentile(0.5), log[2].percentile(1));
+  EXPECT_GE(log[2].percentile(1) * 2, log[2].mTotal);
+  e.resetLog();
+  EXPECT_EQ(e.getLog().size(), 5);
+  EXPECT_EQ(e.getLog()[0].mCalls, 0);
+}
+
+TEST(EvaluatorTest, LogSharedTimingAcrossThreads) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  using SharedEvaluator = Evaluator<U, LogSharedTiming<struct SharedTag>,
+                                    GetMin, GetMax, GetSorted, GetAvg, GetVar>;
+  SharedEvaluator().resetLog();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&vec] {
+      SharedEvaluator own;
+      for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(std::get<0>(own.eval<Min>(vec)), 1);
+        EXPECT_EQ(std::get<0>(own.eval<Max, Sorted>(vec)), 8);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  const LogTiming::Log log = SharedEvaluator().getLog();
+  ASSERT_EQ(log.size(), 5);
+  EXPECT_EQ(log[0].mCalls, 400);
+  EXPECT_EQ(log[0].mBytes, 400 * sizeof(int));
+  EXPECT_EQ(log[2].mCalls, 400);
+  EXPECT_EQ(std::accumulate(log[2].mBuckets.begin(), log[2].mBuckets.end(),
+                            std::size_t{0}),
+            400);
+  EXPECT_EQ(
+      (Evaluator<U, LogSharedTiming<>, GetMin>().getLog()[0].mCalls), 0);
+}
+
+namespace {
+std::vector<std::size_t> toVector(const PositionList &aList) {
+  std::vector<std::size_t> positions(aList.begin(), aList.end());
+  std::sort(positions.begin(), positions.end());
+  return positions;
+}
+} // namespace
+
+TEST(EvaluatorTest, LogTrace) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  ThreadPool pool(2);
+  Evaluator<DepU, WithExecution<ThreadPool &, LogTrace>, DepGetSorted,
+            DepGetAvg, DepGetVar, DepGetMedian>
+      e(pool);
+  e.eval<Var, Min>(vec);
+  LogTrace::Log log = e.getLog();
+  ASSERT_EQ(log.size(), 3);
+  std::sort(log.begin(), log.end(), [](const Span &aLhs, const Span &aRhs) {
+    return aLhs.mFunctorIndex < aRhs.mFunctorIndex;
+  });
+  EXPECT_STREQ(log[0].mFunctor, nameOf<DepGetSorted>());
+  EXPECT_EQ(log[0].mLevel, 0);
+  EXPECT_EQ(toVector(log[0].mCovered), (std::vector<std::size_t>{0}));
+  EXPECT_EQ(log[1].mFunctorIndex, 1);
+  EXPECT_EQ(toVector(log[1].mCovered), (std::vector<std::size_t>{2}));
+  EXPECT_EQ(log[2].mFunctorIndex, 2);
+  EXPECT_EQ(log[2].mLevel, 1);
+  EXPECT_GE(log[2].mStart, log[1].mStart + log[1].mDuration);
+  for (const Span &span : log) {
+    EXPECT_EQ(toVector(span.mQuery), (std::vector<std::size_t>{0, 3}));
+    EXPECT_EQ(span.mAvailable.size(), 0);
+    EXPECT_EQ(toVector(span.mCover), (std::vector<std::size_t>{0, 1, 2}));
+  }
+
+  e.resetLog();
+  e.eval<Avg>(vec);
+  std::ostringstream trace;
+  e.writeChromeTrace(trace);
+  const std::string json = trace.str();
+  EXPECT_EQ(json.rfind(std::string("{\"traceEvents\":[\n{\"name\":\"") +
+                           nameOf<DepGetAvg>() +
+                           "\",\"cat\":\"set_cover\",\"ph\":\"X\","
+                           "\"pid\":0,\"tid\":0,\"ts\":0.000,\"dur\":",
+                       0),
+            0);
+  EXPECT_NE(json.find(",\"args\":{\"functor\":1,\"level\":0,\"query\":[2],"
+                      "\"available\":[],\"cover\":[1],\"covered\":[2]}}\n]}\n"),
+            std::string::npos);
+}
+
+TEST(EvaluatorTest, PlanOf) {
+  constexpr auto plan = MyEvaluator::planOf<Min, Var>();
+  static_assert(plan.size() == 2);
+  static_assert(plan.mFunctors[0] == 0 && plan.mFunctors[1] == 4);
+  static_assert(plan.mCovered[0][0] == U::Set<Min>{});
+  static_assert(plan.mCovered[1][0] == U::Set<Var>{});
+  static_assert(plan.cost() == 2);
+  static_assert(CostedEvaluator<1 << 20>::planOf<Min, Max>(6).cost() == 12);
+  static_assert(MyEvaluator::planOf<>().size() == 0);
+  EXPECT_STREQ(MyEvaluator::functorName(2), "GetSorted");
+}
+
+TEST(EvaluatorTest, WritePlans) {
+  using Queries = std::tuple<U::Set<>, U::Set<Min, Max>, U::Set<Var, Sorted>>;
+  std::ostringstream out;
+  MyEvaluator::writePlans<Queries>(out);
+  EXPECT_EQ(out.str(), "| query | functors | calls | cost |\n"
+                       "|---|---|---:|---:|\n"
+                       "| (none) |  | 0 | 0 |\n"
+                       "| min+max | GetSorted | 1 | 1 |\n"
+                       "| var+sorted | GetVar, GetSorted | 2 | 2 |\n");
+}
+
+// Sorts into a buffer that it keeps across calls, and counts how often the
+// buffer grows.
+struct GetMinMaxWithScratch {
+  using EvalList = U::KPerm<Min, Max>;
+  explicit GetMinMaxWithScratch(std::size_t aCapacity = 0) {
+    mScratch.reserve(aCapacity);
+  }
+  std::tuple<int, int> operator()(const std::vector<int> &aIn) {
+    if (aIn.size() > mScratch.capacity()) {
+      ++mGrowths;
+    }
+    mScratch.assign(aIn.begin(), aIn.end());
+    std::sort(mScratch.begin(), mScratch.end());
+    return {mScratch.front(), mScratch.back()};
+  }
+  std::vector<int> mScratch;
+  int mGrowths = 0;
+};
+
+TEST(EvaluatorTest, FunctorsAreKeptAcrossEvals) {
+  Evaluator<U, LogNothing, GetMinMaxWithScratch, GetAvg> e;
+  e.eval<Min, Max>(std::vector{1, 5, 8, 2, 6, 3});
+  const auto [min, max] = e.eval<Min, Max>(std::vector{4, 9, 7});
+  EXPECT_EQ(min, 4);
+  EXPECT_EQ(max, 9);
+  EXPECT_EQ(e.getFunctor<GetMinMaxWithScratch>().mGrowths, 1);
+  EXPECT_EQ(e.getFunctor<GetMinMaxWithScratch>().mScratch,
+            (std::vector{4, 7, 9}));
+}
+
+TEST(EvaluatorTest, FunctorsPassedIn) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  CachingEvaluator<U, LogNothing, GetMinMaxWithScratch, GetAvg> e(
+      GetMinMaxWithScratch(vec.size()), GetAvg{});
+  e.eval<Min, Max, Avg>(vec);
+  EXPECT_EQ(e.getFunctor<GetMinMaxWithScratch>().mGrowths, 0);
+  EXPECT_GE(e.getFunctor<GetMinMaxWithScratch>().mScratch.capacity(),
+            vec.size());
+}
+
+// Sorts into the storage that it is given.
+struct GetSortedInPlace {
+  using EvalList = U::KPerm<Sorted, Min, Max>;
+  void operator()(InPlace, std::vector<int> &aSorted, int &aMin, int &aMax,
+                  const std::vector<int> &aIn) {
+    aSorted.assign(aIn.begin(), aIn.end());
+    std::sort(aSorted.begin(), aSorted.end());
+    aMin = aSorted.front();
+    aMax = aSorted.back();
+  }
+};
+
+using InPlaceEvaluator = Evaluator<U, LogTypeIndex, GetMin, GetMax,
+                                   GetSortedInPlace, GetAvg, GetVar>;
+
+TEST(EvaluatorTest, EvalInPlace) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  InPlaceEvaluator e;
+  const auto [sorted, min, max] = e.eval<Sorted, Min, Max>(vec);
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  const auto masked = e.evalMask(U::Set<Sorted>{}, vec);
+  EXPECT_EQ(std::get<4>(masked), (std::vector{1, 2, 3, 5, 6, 8}));
+  EXPECT_FALSE(std::get<0>(masked).has_value());
+}
+
+TEST(EvaluatorTest, EvalInto) {
+  InPlaceEvaluator e;
+  std::vector<int> sorted;
+  float var = 0;
+  e.evalInto<Sorted, Var>(sorted, var, std::vector{1, 5, 8, 2, 6, 3});
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  const Log expectedLog = {std::type_index(typeid(GetSortedInPlace)),
+                           std::type_index(typeid(GetVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+
+  const int *const data = sorted.data();
+  int max = 0;
+  e.evalInto<Sorted, Max>(sorted, max, std::vector{4, 9, 7});
+  EXPECT_EQ(sorted, (std::vector{4, 7, 9}));
+  EXPECT_EQ(sorted.data(), data);
+  EXPECT_EQ(max, 9);
+}
+
+struct PmrSorted {
+  using Type = std::pmr::vector<int>;
+};
+
+using PmrU = Universe<PmrSorted, Min>;
+
+// Allocates its result from the resource of the evaluator.
+struct GetPmrSorted {
+  using EvalList = PmrU::KPerm<PmrSorted, Min>;
+  std::tuple<std::pmr::vector<int>, int>
+  operator()(FromResource aFrom, const std::vector<int> &aIn) {
+    std::pmr::vector<int> out(aIn.begin(), aIn.end(), aFrom.mResource);
+    std::sort(out.begin(), out.end());
+    const int min = out.front();
+    return {std::move(out), min};
+  }
+};
+
+TEST(EvaluatorTest, WithMemoryResource) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  Evaluator<PmrU, WithMemoryResource<>, GetPmrSorted> e;
+  {
+    const auto [sorted, min] = e.eval<PmrSorted, Min>(vec);
+    EXPECT_EQ(sorted, (std::pmr::vector<int>{1, 2, 3, 5, 6, 8}));
+    EXPECT_EQ(sorted.get_allocator().resource(), &e.getMemoryResource());
+    EXPECT_EQ(min, 1);
+  }
+  {
+    const auto [sorted, min] =
+        e.evalBatch<PmrSorted, Min>(std::vector{vec, std::vector{4, 9, 7}});
+    ASSERT_EQ(sorted.size(), 2);
+    EXPECT_EQ(sorted[1], (std::pmr::vector<int>{4, 7, 9}));
+    EXPECT_EQ(sorted[0].get_allocator().resource(), &e.getMemoryResource());
+    EXPECT_EQ(sorted[1].get_allocator().resource(), &e.getMemoryResource());
+    EXPECT_EQ(min, (std::vector{1, 4}));
+  }
+  e.releaseMemory();
+
+  Evaluator<PmrU, LogNothing, GetPmrSorted> byDefault;
+  const auto [sorted] = byDefault.eval<PmrSorted>(vec);
+  EXPECT_EQ(sorted.get_allocator().resource(),
+            std::pmr::get_default_resource());
+}
+
+TEST(EvaluatorTest, EvalFused) {
+  const std::vector vec = {1, 5, 8, 2, 6, 3};
+  MyEvaluator e;
+  const auto [minMax, var, sortedMax] =
+      e.evalFused<U::KPerm<Min, Max>, U::KPerm<Var>, U::KPerm<Sorted, Max>>(
+          vec);
+  EXPECT_EQ(minMax, std::make_tuple(1, 8));
+  EXPECT_NEAR(std::get<0>(var), 5.806, 1e-3);
+  EXPECT_EQ(sortedMax, std::make_tuple(std::vector{1, 2, 3, 5, 6, 8}, 8));
+  const Log expectedLog = {std::type_index(typeid(GetVar)),
+                           std::type_index(typeid(GetSorted))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+}
+
+TEST(EvaluatorTest, EvalFusedSharesResults) {
+  const std::vector vec = {3, 1, 2};
+  MyEvaluator e;
+  const auto [sorted, sortedMin] =
+      e.evalFused<U::KPerm<Sorted>, U::KPerm<Min, Sorted>>(vec);
+  EXPECT_EQ(std::get<0>(sorted), (std::vector{1, 2, 3}));
+  EXPECT_EQ(sortedMin, std::make_tuple(1, std::vector{1, 2, 3}));
+  EXPECT_EQ(e.getLog().size(), 1);
+}
+
+// Counts the copies of a result, which moves do not make.
+struct Copies {
+  static inline int sCount = 0;
+  Copies() = default;
+  Copies(const Copies &) { ++sCount; }
+  Copies(Copies &&) = default;
+  Copies &operator=(const Copies &) = default;
+  Copies &operator=(Copies &&) = default;
+};
+
+struct Copied {
+  using Type = Copies;
+};
+
+using CopiedU = Universe<Copied>;
+
+struct GetCopied {
+  using EvalList = CopiedU::KPerm<Copied>;
+  std::tuple<Copies> operator()() { return {}; }
+};
+
+// A result that three queries share is copied into the first two only.
+TEST(EvaluatorTest, EvalFusedMovesIntoTheLastQuery) {
+  Evaluator<CopiedU, LogNothing, GetCopied> e;
+  Copies::sCount = 0;
+  e.evalFused<CopiedU::KPerm<Copied>, CopiedU::KPerm<Copied>,
+              CopiedU::KPerm<Copied>>();
+  EXPECT_EQ(Copies::sCount, 2);
+}
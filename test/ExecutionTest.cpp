@@ -0,0 +1,76 @@
+#include <Execution.h>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+
+using namespace set_cover;
+
+TEST(ExecutionTest, SequentialRunsTasksInOrder) {
+  std::vector<int> order;
+  Sequential().run([&] { order.push_back(0); }, [&] { order.push_back(1); },
+                   [&] { order.push_back(2); });
+  EXPECT_EQ(order, (std::vector{0, 1, 2}));
+}
+
+TEST(ExecutionTest, ThreadPoolRunsEveryTask) {
+  ThreadPool pool(3);
+  EXPECT_EQ(pool.workerCount(), 3);
+  for (int i = 0; i < 100; ++i) {
+    std::atomic<int> sum = 0;
+    pool.run([&] { sum += 1; }, [&] { sum += 2; }, [&] { sum += 4; },
+             [&] { sum += 8; }, [&] { sum += 16; });
+    EXPECT_EQ(sum, 31);
+  }
+}
+
+TEST(ExecutionTest, ThreadPoolRunsSingleTaskOnCaller) {
+  ThreadPool pool(2);
+  std::thread::id id;
+  pool.run([&] { id = std::this_thread::get_id(); });
+  EXPECT_EQ(id, std::this_thread::get_id());
+}
+
+TEST(ExecutionTest, ThreadPoolWithoutWorkersRunsOnCaller) {
+  ThreadPool pool(0);
+  std::thread::id id0;
+  std::thread::id id1;
+  pool.run([&] { id0 = std::this_thread::get_id(); },
+           [&] { id1 = std::this_thread::get_id(); });
+  EXPECT_EQ(id0, std::this_thread::get_id());
+  EXPECT_EQ(id1, std::this_thread::get_id());
+}
+
+TEST(ExecutionTest, ThreadPoolRunsTasksConcurrently) {
+  ThreadPool pool(1);
+  std::atomic<bool> started = false;
+  // The last task runs on the caller, and waits for the first, so the two
+  // must run at once.
+  pool.run([&] { started = true; },
+           [&] {
+             while (!started) {
+               std::this_thread::yield();
+             }
+           });
+  EXPECT_TRUE(started);
+}
+
+TEST(ExecutionTest, ThreadPoolRethrowsAfterTheBatch) {
+  ThreadPool pool(2);
+  std::atomic<int> done = 0;
+  EXPECT_THROW(pool.run([&] { ++done; },
+                        [&]() { throw std::runtime_error("failed"); },
+                        [&] { ++done; }),
+               std::runtime_error);
+  EXPECT_EQ(done, 2);
+}
+
+TEST(ExecutionTest, ThreadPoolRunsNestedBatches) {
+  ThreadPool pool(1);
+  std::atomic<int> sum = 0;
+  const auto nested = [&] {
+    pool.run([&] { sum += 1; }, [&] { sum += 1; });
+  };
+  pool.run(nested, nested, nested);
+  EXPECT_EQ(sum, 6);
+}
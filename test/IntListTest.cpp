@@ -0,0 +1,104 @@
+#include <IntList.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <typeindex>
+
+using namespace set_cover;
+using namespace set_cover::int_list;
+
+namespace {
+std::vector<int> makeInput(std::size_t aSize, int aLow, int aHigh) {
+  std::mt19937 generator(aSize);
+  std::uniform_int_distribution<int> distribution(aLow, aHigh);
+  std::vector<int> input(aSize);
+  for (int &value : input) {
+    value = distribution(generator);
+  }
+  return input;
+}
+
+const Isa kIsas[] = {Isa::Scalar, Isa::Sse41, Isa::Avx2};
+} // namespace
+
+TEST(IntListTest, KernelsAgreeWithScalar) {
+  for (std::size_t size = 1; size < 40; ++size) {
+    const std::vector<int> in =
+        makeInput(size, std::numeric_limits<int>::min(),
+                  std::numeric_limits<int>::max());
+    const auto [min, max] = std::minmax_element(in.begin(), in.end());
+    const auto [avg, var] =
+        averageAndVariance(moments(in.data(), size, Isa::Scalar), size);
+    for (Isa isa : kIsas) {
+      if (!isSupported(isa)) {
+        continue;
+      }
+      EXPECT_EQ(minMax(in.data(), size, isa), std::make_pair(*min, *max));
+      const auto [isaAvg, isaVar] =
+          averageAndVariance(moments(in.data(), size, isa), size);
+      EXPECT_FLOAT_EQ(isaAvg, avg);
+      EXPECT_NEAR(isaVar, var, 1e-6 * var);
+    }
+  }
+}
+
+TEST(IntListTest, VarianceFarFromZero) {
+  std::vector<int> in(1000, 1000000000);
+  for (std::size_t i = 0; i < in.size(); i += 2) {
+    in[i] += 2;
+  }
+  for (Isa isa : kIsas) {
+    if (isSupported(isa)) {
+      const auto [avg, var] =
+          averageAndVariance(moments(in.data(), in.size(), isa), in.size());
+      EXPECT_FLOAT_EQ(avg, 1000000001.0f);
+      EXPECT_FLOAT_EQ(var, 1.0f);
+    }
+  }
+}
+
+TEST(IntListTest, Get) {
+  IntList list({1, 5, 8, 2, 6, 3});
+  const auto [min, max, median] = list.get<Min, Max, Median>();
+  EXPECT_EQ(min, 1);
+  EXPECT_EQ(max, 8);
+  EXPECT_EQ(median, 5);
+  const auto [avg, var] = list.get<Avg, Var>();
+  EXPECT_FLOAT_EQ(avg, 25.0f / 6);
+  EXPECT_NEAR(var, 5.806, 1e-3);
+  const auto [sorted, sortedMedian] = list.get<Sorted, Median>();
+  EXPECT_EQ(sorted, (std::vector{1, 2, 3, 5, 6, 8}));
+  EXPECT_EQ(sortedMedian, 5);
+}
+
+TEST(IntListTest, RejectsEmptyLists) {
+  EXPECT_THROW(IntList(std::vector<int>()), std::invalid_argument);
+}
+
+TEST(IntListTest, CoversShareScans) {
+  constexpr auto plan = IntListEvaluator<>::planOf<Min, Max, Median>();
+  static_assert(plan.size() == 2);
+  static_assert(plan.mFunctors[0] != 3 && plan.mFunctors[1] != 3);
+  static_assert(IntListEvaluator<>::planOf<Sorted, Min, Median>().size() == 1);
+  static_assert(IntListEvaluator<>::planOf<Min, Avg>().size() == 2);
+
+  IntListEvaluator<LogTypeIndex> e;
+  e.eval<Max, Var, Avg>(std::vector{1, 2, 3});
+  const LogTypeIndex::Log expectedLog = {std::type_index(typeid(GetMinMax)),
+                                         std::type_index(typeid(GetAvgVar))};
+  EXPECT_EQ(e.getLog(), expectedLog);
+}
+
+TEST(IntListTest, GetIntoReusesStorage) {
+  IntList list(makeInput(100, -100, 100));
+  std::vector<int> sorted;
+  int min = 0;
+  list.getInto<Sorted, Min>(sorted, min);
+  EXPECT_TRUE(std::is_sorted(sorted.begin(), sorted.end()));
+  EXPECT_EQ(min, sorted.front());
+  const int *const data = sorted.data();
+  list.getInto<Sorted, Min>(sorted, min);
+  EXPECT_EQ(sorted.data(), data);
+}
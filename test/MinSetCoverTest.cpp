@@ -191,3 +191,154 @@ TEST(MinSetCoverTest, GreedyAndLoosestOneWinsTie) {
     EXPECT_FALSE(decltype(hasElement<Result, DE>()){});
   }
 }
+
+struct Cheap {
+  static constexpr std::size_t cost = 1;
+};
+struct Moderate {
+  static constexpr std::size_t cost = 4;
+};
+struct Expensive {
+  static constexpr std::size_t cost = 10;
+};
+struct Linear {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize; }
+};
+struct Quadratic {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize * aSize; }
+};
+struct PerWord {
+  static constexpr std::size_t cost(std::size_t aSize) { return aSize / 64; }
+};
+
+TEST(MinSetCoverTest, CostOf) {
+  EXPECT_EQ(costOf<A>(100), 1);
+  EXPECT_EQ(costOf<Moderate>(100), 4);
+  EXPECT_EQ(costOf<Quadratic>(100), 10000);
+  EXPECT_EQ((costOf<Costed<AE, Linear>>(100)), 100);
+}
+
+TEST(MinSetCoverTest, WeightedGreedyWithoutCostsActsAsGreedy) {
+  using Unweighted = MinSetCover<Greedy<TightestOneWins>>;
+  using Weighted = MinSetCover<WeightedGreedy<TightestOneWins>>;
+  EXPECT_TRUE(
+      (std::is_same_v<decltype(Unweighted::eval<ABCDE, ABCD, CDE, DE>()),
+                      decltype(Weighted::eval<ABCDE, ABCD, CDE, DE>())>));
+  EXPECT_TRUE(
+      (std::is_same_v<decltype(Unweighted::eval<ABCDE, DE, CDE, ABCD>()),
+                      decltype(Weighted::eval<ABCDE, DE, CDE, ABCD>())>));
+}
+
+TEST(MinSetCoverTest, WeightedGreedyPicksLowestCostPerElement) {
+  using ABCDEExpensive = Costed<ABCDE, Expensive>;
+  using ABCDModerate = Costed<ABCD, Moderate>;
+  using AECheap = Costed<AE, Cheap>;
+  {
+    using Result = decltype(MinSetCover<Greedy<TightestOneWins>>::eval<
+                            ABCDE, ABCDEExpensive, ABCDModerate, AECheap>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCDEExpensive>>));
+  }
+  {
+    using Result = decltype(MinSetCover<WeightedGreedy<TightestOneWins>>::eval<
+                            ABCDE, ABCDEExpensive, ABCDModerate, AECheap>());
+    EXPECT_TRUE(decltype(hasElement<Result, AECheap>()){});
+    EXPECT_TRUE(decltype(hasElement<Result, ABCDModerate>()){});
+    EXPECT_FALSE(decltype(hasElement<Result, ABCDEExpensive>()){});
+  }
+}
+
+TEST(MinSetCoverTest, WeightedGreedyEvaluatesCostModelAtSizeHint) {
+  using ABCDEQuadratic = Costed<ABCDE, Quadratic>;
+  using ABCDLinear = Costed<ABCD, Linear>;
+  using AELinear = Costed<AE, Linear>;
+  {
+    using MyMinSetCover = MinSetCover<WeightedGreedy<TightestOneWins, 1>>;
+    using Result = decltype(MyMinSetCover::eval<ABCDE, ABCDLinear, AELinear,
+                                                ABCDEQuadratic>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCDEQuadratic>>));
+  }
+  {
+    using MyMinSetCover = MinSetCover<WeightedGreedy<TightestOneWins, 10>>;
+    using Result = decltype(MyMinSetCover::eval<ABCDE, ABCDLinear, AELinear,
+                                                ABCDEQuadratic>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCDLinear, AELinear>>));
+  }
+}
+
+TEST(MinSetCoverTest, WeightedGreedySkipsFreeCandidatesThatCoverNothing) {
+  // PerWord costs 0 at the default size hint of 1, so AEFree covers A for
+  // free, and then covers nothing of BCD at the same cost per element.
+  using AEFree = Costed<AE, PerWord>;
+  using BCDLinear = Costed<U::Set<B, C, D>, Linear>;
+  using Result = decltype(MinSetCover<WeightedGreedy<TightestOneWins>>::eval<
+                          ABCD, AEFree, BCDLinear>());
+  EXPECT_TRUE((std::is_same_v<Result, std::tuple<AEFree, BCDLinear>>));
+}
+
+using ABC = U::Set<A, B, C>;
+using ABD = U::Set<A, B, D>;
+using CE = U::Set<C, E>;
+
+TEST(MinSetCoverTest, ExactBeatsGreedy) {
+  {
+    using Result = decltype(MinSetCover<Greedy<TightestOneWins>>::eval<
+                            ABCDE, ABC, ABD, CE>());
+    EXPECT_EQ(std::tuple_size_v<Result>, 3);
+  }
+  {
+    using Result = decltype(MinSetCover<Exact>::eval<ABCDE, ABC, ABD, CE>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABD, CE>>));
+  }
+}
+
+TEST(MinSetCoverTest, ExactKeepsCandidateOrder) {
+  using Result = decltype(MinSetCover<Exact>::eval<ABCDE, DE, CE, ABCD>());
+  EXPECT_TRUE((std::is_same_v<Result, std::tuple<DE, ABCD>>));
+}
+
+TEST(MinSetCoverTest, ExactOfEmptySet) {
+  using Empty = std::integral_constant<std::size_t, 0>;
+  using Result = decltype(MinSetCover<Exact>::eval<Empty, ABCD, AE, DE>());
+  EXPECT_TRUE((std::is_same_v<Result, std::tuple<>>));
+}
+
+TEST(MinSetCoverTest, WeightedExactPicksLowestTotalCost) {
+  using ABCDEExpensive = Costed<ABCDE, Expensive>;
+  using ABCDModerate = Costed<ABCD, Moderate>;
+  using AECheap = Costed<AE, Cheap>;
+  using DECheap = Costed<DE, Cheap>;
+  {
+    using Result = decltype(MinSetCover<Exact>::eval<
+                            ABCDE, ABCDModerate, AECheap, DECheap,
+                            ABCDEExpensive>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCDEExpensive>>));
+  }
+  {
+    using Result = decltype(MinSetCover<WeightedExact<>>::eval<
+                            ABCDE, ABCDModerate, AECheap, DECheap,
+                            ABCDEExpensive>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCDModerate, AECheap>>));
+  }
+}
+
+using BCD = U::Set<B, C, D>;
+using AB = U::Set<A, B>;
+
+TEST(MinSetCoverTest, ReverseDeleteDropsRedundantPicks) {
+  {
+    using Result = decltype(MinSetCover<Greedy<TightestOneWins>>::eval<
+                            ABCDE, BCD, AB, CDE>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<BCD, AB, CDE>>));
+  }
+  {
+    using MyMinSetCover = MinSetCover<ReverseDelete<Greedy<TightestOneWins>>>;
+    using Result = decltype(MyMinSetCover::eval<ABCDE, BCD, AB, CDE>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<AB, CDE>>));
+  }
+}
+
+TEST(MinSetCoverTest, ReverseDeleteKeepsIrredundantPicks) {
+  using MyMinSetCover = MinSetCover<ReverseDelete<Greedy<TightestOneWins>>>;
+  using Result = decltype(MyMinSetCover::eval<ABCDE, ABCD, AE, DE>());
+  EXPECT_TRUE((std::is_same_v<Result, std::tuple<ABCD, AE>>));
+}
@@ -0,0 +1,126 @@
+#include <MinSetCover.h>
+#include <TypeSet.h>
+#include <gtest/gtest.h>
+
+using namespace set_cover;
+
+struct A {};
+struct B {};
+struct C {};
+
+using U = Universe<A, B, C>;
+
+template <std::size_t tI> struct E {};
+
+namespace {
+
+template <std::size_t... tIs>
+auto makeUniverse(std::index_sequence<tIs...>) -> Universe<E<tIs>...>;
+
+template <std::size_t tN>
+using UniverseOf = decltype(makeUniverse(std::make_index_sequence<tN>{}));
+
+template <typename tElement, std::size_t... tIs>
+auto flagOf(std::index_sequence<tIs...>)
+    -> decltype(flag<tElement, E<tIs>...>());
+
+} // namespace
+
+using U64 = UniverseOf<64>;
+using U150 = UniverseOf<150>;
+
+template <std::size_t tWord>
+using Word = std::integral_constant<std::size_t, tWord>;
+
+constexpr std::size_t bit(std::size_t aI) { return std::size_t{1} << aI; }
+
+TEST(TypeSetTest, NarrowSetsAreSingleWords) {
+  EXPECT_TRUE((std::is_same_v<U::Set<A, C>, Word<0b101>>));
+  EXPECT_TRUE((std::is_same_v<U::Set<>, Word<0>>));
+  EXPECT_TRUE((std::is_same_v<U64::Set<E<31>>, Word<bit(31)>>));
+  EXPECT_TRUE((std::is_same_v<U64::Set<E<32>>, Word<bit(32)>>));
+  EXPECT_TRUE((std::is_same_v<U64::Set<E<0>, E<63>>, Word<bit(0) | bit(63)>>));
+}
+
+TEST(TypeSetTest, WideSetsSpanWords) {
+  EXPECT_TRUE((std::is_same_v<U150::Set<E<0>, E<64>, E<149>>,
+                              WideSet<bit(0), bit(0), bit(149 - 128)>>));
+  EXPECT_TRUE((std::is_same_v<U150::Set<E<70>>, WideSet<0, bit(70 - 64)>>));
+  // Sets that fit in the first word stay single words in a wide universe.
+  EXPECT_TRUE((std::is_same_v<U150::Set<E<5>, E<63>>, Word<bit(5) | bit(63)>>));
+}
+
+TEST(TypeSetTest, Flag) {
+  EXPECT_EQ((flag<B, A, B, C>()), 0b010);
+  EXPECT_TRUE((std::is_same_v<decltype(flag<E<100>, E<0>, E<10>, E<100>>()),
+                              Word<bit(2)>>));
+  EXPECT_TRUE((std::is_same_v<decltype(flagOf<E<140>>(
+                                  std::make_index_sequence<150>{})),
+                              U150::Set<E<140>>>));
+}
+
+TEST(TypeSetTest, Size) {
+  EXPECT_EQ((size<U::Set<A, C>>()), 2);
+  EXPECT_EQ((size<U150::Set<>>()), 0);
+  EXPECT_EQ((size<U150::Set<E<0>, E<64>, E<128>, E<149>>>()), 4);
+}
+
+TEST(TypeSetTest, CommonalityAndDifference) {
+  using S0 = U150::Set<E<1>, E<65>, E<130>, E<140>>;
+  using S1 = U150::Set<E<1>, E<66>, E<140>>;
+  using S2 = U150::Set<E<1>, E<2>>;
+  EXPECT_EQ((commonality<S0, S1>()), 2);
+  EXPECT_EQ((difference<S0, S1>()), 3);
+  EXPECT_EQ((commonality<S0, S2>()), 1);
+  EXPECT_EQ((difference<S0, S2>()), 4);
+  EXPECT_EQ((difference<S2, S2>()), 0);
+}
+
+TEST(TypeSetTest, SetAlgebraIsCanonical) {
+  using S0 = U150::Set<E<1>, E<65>, E<140>>;
+  using S1 = U150::Set<E<65>, E<140>>;
+  EXPECT_TRUE((std::is_same_v<SetMinus<S0, S1>, U150::Set<E<1>>>));
+  EXPECT_TRUE((std::is_same_v<SetMinus<S1, S0>, U150::Set<>>));
+  EXPECT_TRUE((std::is_same_v<SetIntersection<S0, S1>, S1>));
+  EXPECT_TRUE((std::is_same_v<SetUnion<U150::Set<E<1>>, S1>, S0>));
+  EXPECT_TRUE((isEmpty<SetMinus<S1, S0>>()));
+  EXPECT_FALSE(isEmpty<S1>());
+}
+
+TEST(TypeSetTest, ToCanonicalList) {
+  EXPECT_TRUE((std::is_same_v<decltype(toCanonicalList<U::Set<C, A>>()),
+                              std::index_sequence<0, 2>>));
+  EXPECT_TRUE((std::is_same_v<decltype(toCanonicalList<U::Set<>>()),
+                              std::index_sequence<>>));
+  EXPECT_TRUE(
+      (std::is_same_v<decltype(toCanonicalList<
+                               U150::Set<E<149>, E<3>, E<64>, E<63>>>()),
+                      std::index_sequence<3, 63, 64, 149>>));
+}
+
+TEST(TypeSetTest, ToSetRoundTrips) {
+  using S = U150::Set<E<7>, E<77>, E<147>>;
+  EXPECT_TRUE((std::is_same_v<decltype(toSet(toCanonicalList<S>())), S>));
+}
+
+TEST(TypeSetTest, MinSetCoverOverWideSets) {
+  using Query = U150::Set<E<0>, E<70>, E<140>, E<149>>;
+  using S0 = U150::Set<E<0>, E<70>>;
+  using S1 = U150::Set<E<140>>;
+  using S2 = U150::Set<E<70>, E<140>, E<149>>;
+  using S3 = U150::Set<E<0>>;
+  {
+    using MyMinSetCover = MinSetCover<Greedy<TightestOneWins>>;
+    using Result = decltype(MyMinSetCover::eval<Query, S0, S1, S2, S3>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<S2, S3>>));
+  }
+  {
+    using Result = decltype(MinSetCover<Exact>::eval<Query, S0, S1, S2, S3>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<S0, S2>>));
+  }
+  {
+    using MyMinSetCover = MinSetCover<ReverseDelete<Greedy<FirstOneWins>>>;
+    using Result = decltype(MyMinSetCover::eval<Query, S0, S1, S2>());
+    EXPECT_TRUE((std::is_same_v<Result, std::tuple<S2, S0>>));
+  }
+}